@@ -16,12 +16,34 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
 #include <string>
 #include <sstream>
 #include <algorithm>
 #include <cmath>
 #include <limits>
 #include <locale>
+#include <random>
+#include <iomanip>
+#include <cstdlib>
+#include <cctype>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <fstream>
+#include <cstdio>
+#include <csignal>
+#if defined(__linux__)
+#include <sys/mman.h> // Huge pages for the transposition tables
+#include <fcntl.h>    // Mapping a saved hash file
+#include <unistd.h>
+#include <pthread.h>  // Forwarding interrupts to the main thread
+#endif
 
 using uint64 = unsigned long long;
 
@@ -167,63 +189,64 @@ namespace Core {
     }
 
     /**
-     * @brief Calculates all legal moves (pure move generator).
-     * * @param state The current game state.
+     * @brief Shifts every disc of a bitboard one step in a direction.
+     * * @param board The bitboard to shift.
+     * @param direction The direction of movement (from the DIRECTIONS array).
+     * @return The shifted bitboard, with wrap-around bits removed.
+     */
+    uint64 shift_board(uint64 board, int direction) {
+        // Same wrap-around masks as the single-disc walk above
+        if (direction == -1 || direction == -9 || direction == 7) {
+            board &= MASK_H;
+        } else if (direction == 1 || direction == 9 || direction == -7) {
+            board &= MASK_A;
+        }
+        return (direction < 0) ? (board >> (-direction)) : (board << direction);
+    }
+
+    /**
+     * @brief Calculates all legal moves for a raw pair of bitboards.
+     * * Walks all of the own discs through the opponent's discs at once, one
+     * direction at a time, so the cost does not depend on the number of empty cells.
+     * @param own_board The moving player's bitboard.
+     * @param opp_board The opponent's bitboard.
      * @return A bitmask (uint64) where active bits indicate legal move positions.
      */
-    uint64 generate_legal_moves(const GameState& state) {
-        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
-        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
-        
-        // Empty board (where discs can be placed)
+    uint64 get_moves(uint64 own_board, uint64 opp_board) {
         uint64 empty_board = ~(own_board | opp_board);
         uint64 legal_moves = 0;
 
-        // Iterate through all empty cells
-        for (int i = 0; i < 64; ++i) {
-            uint64 move_mask = (1ULL << i);
-
-            if (move_mask & empty_board) {
-                uint64 total_flips = 0;
-
-                // Check in all eight directions
-                for (int d = 0; d < 8; ++d) {
-                    uint64 mask = 0xFFFFFFFFFFFFFFFFULL; // Default mask (columns B-G)
-                    
-                    // Determine the wrap-around mask
-                    int dir = DIRECTIONS[d];
-                    if (dir % 8 != 0) { // Horizontal/diagonal directions
-                        // West directions (-1, -9, -7): prevent wrap from column A
-                        if (dir == -1 || dir == -9 || dir == 7) {
-                            mask = MASK_H; 
-                        }
-                        // East directions (1, 9, 7): prevent wrap from column H
-                        else if (dir == 1 || dir == 9 || dir == -7) {
-                            mask = MASK_A;
-                        }
-                    }
-
-                    total_flips |= get_flips_in_direction(move_mask, own_board, opp_board, DIRECTIONS[d], mask);
-                }
-
-                if (total_flips != 0) {
-                    legal_moves |= move_mask;
-                }
+        for (int d = 0; d < 8; ++d) {
+            // A line of at most six opponent discs can sit between a move and an own disc
+            uint64 line = shift_board(own_board, DIRECTIONS[d]) & opp_board;
+            for (int step = 0; step < 5; ++step) {
+                line |= shift_board(line, DIRECTIONS[d]) & opp_board;
             }
+            legal_moves |= shift_board(line, DIRECTIONS[d]) & empty_board;
         }
         return legal_moves;
     }
 
     /**
-     * @brief Calculates all discs flipped for a specific move.
+     * @brief Calculates all legal moves (pure move generator).
      * * @param state The current game state.
+     * @return A bitmask (uint64) where active bits indicate legal move positions.
+     */
+    uint64 generate_legal_moves(const GameState& state) {
+        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
+        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
+        return get_moves(own_board, opp_board);
+    }
+
+    /**
+     * @brief Calculates all discs flipped for a move on a raw pair of bitboards.
+     * * @param own_board The moving player's bitboard.
+     * @param opp_board The opponent's bitboard.
      * @param move_index The 0-63 index of the valid move.
      * @return Bitmask of the flipped discs.
      */
-    uint64 get_flips_for_move(const GameState& state, int move_index) {
+    uint64 get_flips(uint64 own_board, uint64 opp_board, int move_index) {
         uint64 move_mask = (1ULL << move_index);
-        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
-        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
         uint64 total_flips = 0;
 
         // Same as the move generator, but counts total flips
@@ -246,6 +269,18 @@ namespace Core {
         return total_flips;
     }
 
+    /**
+     * @brief Calculates all discs flipped for a specific move.
+     * * @param state The current game state.
+     * @param move_index The 0-63 index of the valid move.
+     * @return Bitmask of the flipped discs.
+     */
+    uint64 get_flips_for_move(const GameState& state, int move_index) {
+        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
+        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
+        return get_flips(own_board, opp_board, move_index);
+    }
+
     /**
      * @brief Applies a valid move and returns a new state (pure function).
      * * @param state The current game state.
@@ -342,6 +377,67 @@ namespace Core {
 
         return false;
     }
+
+    // Diagonal lines, for stability: A1-H8 direction (index step 9), then H1-A8 direction (index step 7)
+    const uint64 DIAGONAL_LINES_9[15] = {
+        0x0000000000000080ULL, 0x0000000000008040ULL, 0x0000000000804020ULL, 0x0000000080402010ULL,
+        0x0000008040201008ULL, 0x0000804020100804ULL, 0x0080402010080402ULL, 0x8040201008040201ULL,
+        0x4020100804020100ULL, 0x2010080402010000ULL, 0x1008040201000000ULL, 0x0804020100000000ULL,
+        0x0402010000000000ULL, 0x0201000000000000ULL, 0x0100000000000000ULL
+    };
+    const uint64 DIAGONAL_LINES_7[15] = {
+        0x0000000000000001ULL, 0x0000000000000102ULL, 0x0000000000010204ULL, 0x0000000001020408ULL,
+        0x0000000102040810ULL, 0x0000010204081020ULL, 0x0001020408102040ULL, 0x0102040810204080ULL,
+        0x0204081020408000ULL, 0x0408102040800000ULL, 0x0810204080000000ULL, 0x1020408000000000ULL,
+        0x2040800000000000ULL, 0x4080000000000000ULL, 0x8000000000000000ULL
+    };
+
+    const uint64 EDGE_COLUMNS = 0x8181818181818181ULL; // Columns A and H
+    const uint64 EDGE_ROWS = 0xFF000000000000FFULL;    // Rows 1 and 8
+
+    /**
+     * @brief Finds discs that can never be flipped again (a safe under-estimate).
+     * * A disc is stable when, along each of the four lines through it, the line
+     * is full, or it touches the board edge, or it touches a stable disc of the
+     * same colour. Starting from the corners, this is repeated until nothing changes.
+     * @param own_board The bitboard whose stable discs are wanted.
+     * @param opp_board The other player's bitboard.
+     * @return Bitmask of stable discs of `own_board`.
+     */
+    uint64 get_stable_discs(uint64 own_board, uint64 opp_board) {
+        uint64 filled = own_board | opp_board;
+
+        // Cells whose horizontal / vertical / diagonal line is completely filled
+        uint64 row = filled & (filled >> 1);
+        row &= row >> 2;
+        row &= row >> 4;
+        uint64 full_h = (row & 0x0101010101010101ULL) * 0xFF;
+
+        uint64 column = filled & (filled >> 8);
+        column &= column >> 16;
+        column &= column >> 32;
+        uint64 full_v = (column & 0xFF) * 0x0101010101010101ULL;
+
+        uint64 full_9 = 0, full_7 = 0;
+        for (int k = 0; k < 15; ++k) {
+            if ((filled & DIAGONAL_LINES_9[k]) == DIAGONAL_LINES_9[k]) full_9 |= DIAGONAL_LINES_9[k];
+            if ((filled & DIAGONAL_LINES_7[k]) == DIAGONAL_LINES_7[k]) full_7 |= DIAGONAL_LINES_7[k];
+        }
+
+        const uint64 border = EDGE_COLUMNS | EDGE_ROWS;
+        uint64 stable = 0;
+        while (true) {
+            uint64 safe_h = full_h | EDGE_COLUMNS | shift_board(stable, 1) | shift_board(stable, -1);
+            uint64 safe_v = full_v | EDGE_ROWS | shift_board(stable, 8) | shift_board(stable, -8);
+            uint64 safe_9 = full_9 | border | shift_board(stable, 9) | shift_board(stable, -9);
+            uint64 safe_7 = full_7 | border | shift_board(stable, 7) | shift_board(stable, -7);
+            uint64 next = own_board & safe_h & safe_v & safe_9 & safe_7;
+            if (next == stable) {
+                return stable;
+            }
+            stable = next;
+        }
+    }
 } // namespace Core
 
 
@@ -367,7 +463,12 @@ namespace Engine {
 
     /**
      * @brief Calculates the heuristic value for a GameState (Evaluation).
-     * * @param state The game state.
+     * * Scores swing between odd and even search depths: the player who made
+     * the last move of a line gains discs and position the other has not yet
+     * answered, so odd and even depths are biased in opposite directions and
+     * their values are not comparable. The search therefore compares and
+     * shifts depths only by even amounts.
+     * @param state The game state.
      * @param player The player being evaluated (maximize).
      * @return Integer heuristic value.
      */
@@ -421,189 +522,2719 @@ namespace Engine {
         return ai_score - opp_score;
     }
 
+    // ---------------------------------------------------------------------
+    // Transposition table
+    // ---------------------------------------------------------------------
+
     /**
-     * @brief Implementation of the Minimax algorithm with Alpha-Beta Pruning.
-     * * @param state The current game state.
-     * @param depth The remaining search depth.
-     * @param alpha The alpha value (maximum).
-     * @param beta The beta value (minimum).
-     * @param maximizing_player True if it's the AI's turn (maximizing), False if it's the opponent's (minimizing).
-     * @param ai_player The player running the AI (used for the final evaluation).
-     * @return The best heuristic value found.
+     * @brief Hashes a position given as (player to move, opponent) bitboards.
+     * * Two rounds of the splitmix64 finalizer; cheap next to a move generation.
      */
-    int minimax_ab(GameState state, int depth, int alpha, int beta, bool maximizing_player, Player ai_player) {
-        
-        uint64 legal_moves_mask = Core::generate_legal_moves(state);
+    uint64 hash_position(uint64 own_board, uint64 opp_board) {
+        auto mix = [](uint64 x) {
+            x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+            x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        };
+        return mix(own_board ^ mix(opp_board ^ 0x9E3779B97F4A7C15ULL));
+    }
 
-        // Terminal Case: Depth 0 or Game Over
-        GameState opponent_state = state;
-        opponent_state.current_player = switch_player(state.current_player);
-        uint64 opponent_legal_moves = Core::generate_legal_moves(opponent_state);
-        if (depth == 0 || Core::is_terminal(state, legal_moves_mask, opponent_legal_moves)) {
-            return evaluate(state, ai_player);
+    // Folded into the key when White is to move: the midgame search scores positions
+    // for a fixed player, so unlike the endgame solver it must tell the colours apart
+    const uint64 WHITE_TO_MOVE_KEY = 0x5851F42D4C957F2DULL;
+    // Folded into the key when the scores are White's: a table kept between searches
+    // serves both the AI and the hint, which score the same positions for different players
+    const uint64 WHITE_SCORES_KEY = 0x14057B7EF767814FULL;
+
+    /**
+     * @brief Table key of a position in the midgame search.
+     * * @param own_board The bitboard of the player to move.
+     * @param opp_board The opponent's bitboard.
+     * @param to_move The player to move.
+     * @param ai_player The player the scores are for.
+     */
+    uint64 search_key(uint64 own_board, uint64 opp_board, Player to_move, Player ai_player) {
+        uint64 key = hash_position(own_board, opp_board);
+        if (to_move == Player::White) {
+            key ^= WHITE_TO_MOVE_KEY;
+        }
+        if (ai_player == Player::White) {
+            key ^= WHITE_SCORES_KEY;
         }
+        return key;
+    }
 
-        // ----------------------------------------------------
-        // Pass Case
-        if (Core::count_discs(legal_moves_mask) == 0) {
-            GameState next_state = Core::apply_pass(state);
-            return minimax_ab(next_state, depth, alpha, beta, !maximizing_player, ai_player);
+    /**
+     * @brief What a stored score says about the true value of a position.
+     */
+    enum class Bound : unsigned char {
+        Exact, // The score is the value
+        Lower, // The value is at least the score (the search failed high)
+        Upper  // The value is at most the score (the search failed low)
+    };
+
+    /**
+     * @brief One stored search result.
+     */
+    struct TTEntry {
+        int score = 0;
+        int depth = -1;
+        Bound bound = Bound::Exact;
+        int best_move = -1;
+    };
+
+    /**
+     * @brief Zeroed memory for a large table, on 2 MB pages where the system allows.
+     * * Random table accesses miss the TLB at almost every probe when the table
+     * spans many 4 KB pages. On Linux, explicit huge pages (MAP_HUGETLB) are
+     * tried first, then ordinary pages marked for transparent huge pages
+     * (madvise); other systems get ordinary memory.
+     */
+    class LargePageBuffer {
+    public:
+        LargePageBuffer() = default;
+
+        explicit LargePageBuffer(size_t bytes) {
+#if defined(__linux__)
+            const size_t HUGE_PAGE = 2 * 1024 * 1024;
+            size_t rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+#ifdef MAP_HUGETLB
+            void* memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (memory != MAP_FAILED) {
+                data_ = memory;
+                size_ = rounded;
+                huge_pages_ = true;
+                return;
+            }
+#endif
+            void* memory_4k = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory_4k == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+#ifdef MADV_HUGEPAGE
+            madvise(memory_4k, rounded, MADV_HUGEPAGE); // Only a hint: failure keeps 4 KB pages
+#endif
+            data_ = memory_4k;
+            size_ = rounded;
+#else
+            data_ = std::calloc(bytes, 1);
+            if (data_ == nullptr) {
+                throw std::bad_alloc();
+            }
+            size_ = bytes;
+#endif
         }
-        // ----------------------------------------------------
 
-        if (maximizing_player) { // AI Player
-            int max_eval = std::numeric_limits<int>::min();
+        /**
+         * @brief Maps part of a file as private memory: written pages are copied, the file is never changed.
+         * * Pages are read in when first touched, so a large table is usable at
+         * once. Where the file cannot be mapped (or on other systems), the range
+         * is read into ordinary memory instead.
+         * * @param offset Start of the range; a multiple of the page size for mapping.
+         * @return An empty buffer (data() is null) when the range cannot be read.
+         */
+        static LargePageBuffer from_file(const std::string& path, size_t offset, size_t bytes) {
+            LargePageBuffer buffer;
+#if defined(__linux__)
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return buffer;
+            }
+            void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)offset);
+            close(fd); // The mapping keeps the file open
+            if (memory != MAP_FAILED) {
+                buffer.data_ = memory;
+                buffer.size_ = bytes;
+                return buffer;
+            }
+#endif
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                return buffer;
+            }
+            buffer = LargePageBuffer(bytes);
+            file.seekg((std::streamoff)offset);
+            file.read(static_cast<char*>(buffer.data_), (std::streamsize)bytes);
+            if (!file) {
+                buffer = LargePageBuffer();
+            }
+            return buffer;
+        }
 
-            for (int i = 0; i < 64; ++i) {
-                if (legal_moves_mask & (1ULL << i)) {
-                    GameState next_state = Core::apply_move(state, i);
-                    int eval = minimax_ab(next_state, depth - 1, alpha, beta, false, ai_player);
-                    max_eval = std::max(max_eval, eval);
-                    alpha = std::max(alpha, max_eval);
-                    if (beta <= alpha) {
-                        break; // Pruning
-                    }
-                }
+        ~LargePageBuffer() {
+            release();
+        }
+
+        LargePageBuffer(const LargePageBuffer&) = delete;
+        LargePageBuffer& operator=(const LargePageBuffer&) = delete;
+
+        LargePageBuffer(LargePageBuffer&& other) {
+            *this = std::move(other);
+        }
+
+        LargePageBuffer& operator=(LargePageBuffer&& other) {
+            if (this != &other) {
+                release();
+                std::swap(data_, other.data_);
+                std::swap(size_, other.size_);
+                std::swap(huge_pages_, other.huge_pages_);
             }
-            return max_eval;
-        } else { // Opponent Player
-            int min_eval = std::numeric_limits<int>::max();
+            return *this;
+        }
 
-            for (int i = 0; i < 64; ++i) {
-                if (legal_moves_mask & (1ULL << i)) {
-                    GameState next_state = Core::apply_move(state, i);
-                    int eval = minimax_ab(next_state, depth - 1, alpha, beta, true, ai_player);
-                    min_eval = std::min(min_eval, eval);
-                    beta = std::min(beta, min_eval);
-                    if (beta <= alpha) {
-                        break; // Pruning
-                    }
-                }
+        void* data() const {
+            return data_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        bool huge_pages() const {
+            return huge_pages_;
+        }
+
+    private:
+        void* data_ = nullptr;
+        size_t size_ = 0;
+        bool huge_pages_ = false; // Explicit huge pages (transparent ones cannot be told apart)
+
+        void release() {
+            if (data_ == nullptr) {
+                return;
             }
-            return min_eval;
+#if defined(__linux__)
+            munmap(data_, size_);
+#else
+            std::free(data_);
+#endif
+            data_ = nullptr;
+            size_ = 0;
+            huge_pages_ = false;
         }
-    }
+    };
 
     /**
-     * @brief Finds the best move for the AI (main AI function).
-     * * @param state The current game state.
-     * @param depth The search depth.
-     * @return The index of the best move (0-63), or -1 for a pass.
+     * @brief A fixed-size hash table of search results, one entry per slot.
+     * * A store replaces the slot's entry unless that entry belongs to another
+     * position, was stored during the current generation and is deeper; an
+     * entry of the same position is always replaced, even by a shallower one.
+     * Each search starts a new generation, so entries of earlier searches stay
+     * usable but give way to anything. The generation has 7 bits and wraps
+     * after 128 searches: an entry that old counts as current again, which
+     * only protects it from shallower stores until the next generation.
+     * Lock-free, so search threads can share it: each slot holds the packed
+     * entry and the key xor-ed with it. A slot torn by two concurrent writes
+     * no longer matches any key and simply reads as empty. The slots live in
+     * a LargePageBuffer.
      */
-    int find_best_move(const GameState& state, int depth) {
-        uint64 legal_moves_mask = Core::generate_legal_moves(state);
-        
-        if (Core::count_discs(legal_moves_mask) == 0) {
-            return -1; // Pass
+    class TranspositionTable {
+    private:
+        struct Slot {
+            std::atomic<uint64> check{0}; // key ^ data
+            std::atomic<uint64> data{0};  // Packed entry, 0 when empty
+        };
+        LargePageBuffer memory_;
+        Slot* slots_ = nullptr;
+        uint64 mask_ = 0;
+        unsigned int generation_ = 0; // 7 bits, stored with each entry
+
+        static uint64 pack(int depth, int score, Bound bound, int best_move, unsigned int generation) {
+            return (uint64)(unsigned int)score
+                 | ((uint64)(unsigned char)depth << 32)
+                 | ((uint64)bound << 40)
+                 | ((uint64)(unsigned char)best_move << 48)
+                 | ((uint64)generation << 56)
+                 | (1ULL << 63); // Never 0
         }
 
-        int best_move_index = -2; // Default invalid index
-        int best_eval = std::numeric_limits<int>::min();
+    public:
+        /**
+         * @param size_bits The table holds 2^size_bits entries.
+         */
+        explicit TranspositionTable(int size_bits) {
+            resize(size_bits);
+        }
 
-        // Find the best move at the root level
-        for (int i = 0; i < 64; ++i) {
-            if (legal_moves_mask & (1ULL << i)) {
-                // Apply the move
-                GameState next_state = Core::apply_move(state, i);
-                
-                // Call Minimax on the next level (minimizer)
-                int current_eval = minimax_ab(next_state, depth - 1, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), false, state.current_player);
+        /**
+         * @brief Reallocates the table with 2^size_bits entries; all entries are lost.
+         * * Must not be called during a search.
+         */
+        void resize(int size_bits) {
+            size_t count = (size_t)1 << size_bits;
+            memory_ = LargePageBuffer(); // Frees the old table first, to stay within the memory budget
+            memory_ = LargePageBuffer(count * sizeof(Slot));
+            slots_ = static_cast<Slot*>(memory_.data());
+            for (size_t i = 0; i < count; ++i) {
+                new (&slots_[i]) Slot(); // The memory is zeroed; this only starts the atomics' lifetimes
+            }
+            mask_ = count - 1;
+        }
 
-                if (current_eval > best_eval) {
-                    best_eval = current_eval;
-                    best_move_index = i;
-                }
+        /**
+         * @brief The largest size_bits whose table fits in a number of bytes (at least 10).
+         */
+        static int bits_for_bytes(size_t bytes) {
+            int bits = 10;
+            while (((size_t)2 << bits) * sizeof(Slot) <= bytes) {
+                ++bits;
             }
+            return bits;
         }
-        
-        return best_move_index;
-    }
 
-} // namespace Engine
+        size_t size_bytes() const {
+            return (mask_ + 1) * sizeof(Slot);
+        }
 
+        bool huge_pages() const {
+            return memory_.huge_pages();
+        }
 
-// =========================================================================
-// Part 3: UI & APP (GameController & Main Loop)
-// =========================================================================
+        unsigned int generation() const {
+            return generation_;
+        }
 
-namespace UI {
+        /**
+         * @brief The slots as raw bytes (size_bytes() of them), for saving the table.
+         * * Must not be called during a search.
+         */
+        const void* raw_slots() const {
+            return slots_;
+        }
 
-    /**
-     * @brief Displays the game board, score, and turn with a larger UI.
-     */
-    void print_board(const GameState& state, uint64 legal_moves = 0ULL) {
-        // Column header row
-        std::cout << "\n  ";
-        for (int i = 0; i < 8; ++i) {
-            std::cout << "  " << (char)('A' + i) << " ";
+        /**
+         * @brief Takes over slots saved from a table of the same size, and their generation.
+         * * Must not be called during a search.
+         */
+        void adopt(LargePageBuffer&& memory, unsigned int generation) {
+            memory_ = std::move(memory);
+            slots_ = static_cast<Slot*>(memory_.data()); // Two plain 64-bit words each, as written by raw_slots()
+            generation_ = generation & 0x7F;
         }
-        std::cout << "\n";
 
-        // Top border of the board
-        std::cout << "\033[90m  +"; // Grey color
-        for (int i = 0; i < 8; ++i) {
-            std::cout << "---+";
+        bool probe(uint64 key, TTEntry& entry) const {
+            const Slot& slot = slots_[key & mask_];
+            uint64 data = slot.data.load(std::memory_order_relaxed);
+            uint64 check = slot.check.load(std::memory_order_relaxed);
+            if (data == 0 || (check ^ data) != key) {
+                return false;
+            }
+            entry.score = (int)(unsigned int)data;
+            entry.depth = (int)(unsigned char)(data >> 32);
+            entry.bound = (Bound)((data >> 40) & 0x3);
+            entry.best_move = (int)(signed char)(data >> 48);
+            return true;
         }
-        std::cout << "\033[0m\n"; // Reset color
 
-        for (int row = 0; row < 8; ++row) {
-            // Row with pieces
-            std::cout << "\033[90m" << row + 1 << " |\033[0m"; // Grey color for row number and left border
-            for (int col = 0; col < 8; ++col) {
-                int index = row * 8 + col;
-                uint64 mask = (1ULL << index);
-                std::string piece_str = " ";
-                bool is_legal = (legal_moves & mask);
+        /**
+         * @brief Stores an entry. A deeper entry of another position stored during the
+         * current generation is kept; entries of older generations are always replaced.
+         */
+        void store(uint64 key, int depth, int score, Bound bound, int best_move) {
+            Slot& slot = slots_[key & mask_];
+            uint64 old_data = slot.data.load(std::memory_order_relaxed);
+            if (old_data != 0 && ((old_data >> 56) & 0x7F) == generation_ && (int)(unsigned char)(old_data >> 32) > depth &&
+                (slot.check.load(std::memory_order_relaxed) ^ old_data) != key) {
+                return;
+            }
+            uint64 data = pack(depth, score, bound, best_move, generation_);
+            slot.check.store(key ^ data, std::memory_order_relaxed);
+            slot.data.store(data, std::memory_order_relaxed);
+        }
 
-                if (state.black_discs & mask) {
-                    piece_str = "\033[94m\u25CF\033[0m"; // Bright Blue
-                } else if (state.white_discs & mask) {
-                    piece_str = "\033[93m\u25CF\033[0m"; // Yellow
-                } else if (is_legal) {
-                    piece_str = ".";
-                }
+        /**
+         * @brief Starts loading the slot of a key into the cache.
+         * * Issued as soon as a node's key is known, the load overlaps the move
+         * generation that comes before the probe; in a large table the probe
+         * would otherwise wait on main memory at nearly every node.
+         */
+        void prefetch(uint64 key) const {
+#if defined(__GNUC__)
+            __builtin_prefetch(&slots_[key & mask_]);
+#else
+            (void)key;
+#endif
+        }
 
-                std::cout << " " << piece_str << " \033[90m|\033[0m"; // Grey color for vertical separators
+        /**
+         * @brief Starts a new search: earlier entries stay usable but become replaceable.
+         * * Cheaper than clear() for a table kept between searches.
+         */
+        void new_generation() {
+            generation_ = (generation_ + 1) & 0x7F;
+        }
+
+        void clear() {
+            for (uint64 i = 0; i <= mask_; ++i) {
+                slots_[i].check.store(0, std::memory_order_relaxed);
+                slots_[i].data.store(0, std::memory_order_relaxed);
             }
-            std::cout << "\n";
+        }
+    };
 
-            // Row border
-            std::cout << "\033[90m  +"; // Grey color
-            for (int i = 0; i < 8; ++i) {
-                std::cout << "---+";
+    // ---------------------------------------------------------------------
+    // Hash file
+    // ---------------------------------------------------------------------
+
+    // Bump whenever stored entries change meaning: their packing, or the evaluation behind the scores
+    const uint64 HASH_FILE_VERSION = 1;
+    const uint64 HASH_FILE_MAGIC = 0x4853414830414F59ULL; // "YAO0HASH" read little-endian
+    const size_t HASH_FILE_HEADER_BYTES = 4096;           // One page, so the tables can be mapped
+
+    /**
+     * @brief The start of a hash file, followed by the midgame slots and then the endgame slots.
+     * * The file is only meant for the machine and build that wrote it.
+     */
+    struct HashFileHeader {
+        uint64 magic = HASH_FILE_MAGIC; // Also tells apart a machine of the other byte order
+        uint64 version = HASH_FILE_VERSION;
+        uint64 key_check = 0;           // A known key: another hash function would make every entry unreachable
+        uint64 search_bytes = 0;
+        uint64 endgame_bytes = 0;
+        uint64 search_generation = 0;
+        uint64 endgame_generation = 0;
+    };
+
+    uint64 hash_file_key_check() {
+        return search_key(0x0000000810000000ULL, 0x0000001008000000ULL, Player::White, Player::White);
+    }
+
+    /**
+     * @brief Writes both kept tables to a file, with no search running.
+     * * Goes through a temporary file that replaces the old one at the end, so a
+     * save cut short leaves the previous file intact.
+     * @return False when the file cannot be written.
+     */
+    bool save_hash_file(const std::string& path, const TranspositionTable& search_tt, const TranspositionTable& endgame_tt) {
+        HashFileHeader header;
+        header.key_check = hash_file_key_check();
+        header.search_bytes = search_tt.size_bytes();
+        header.endgame_bytes = endgame_tt.size_bytes();
+        header.search_generation = search_tt.generation();
+        header.endgame_generation = endgame_tt.generation();
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            std::vector<char> page(HASH_FILE_HEADER_BYTES, 0);
+            std::copy_n(reinterpret_cast<const char*>(&header), sizeof(header), page.begin());
+            file.write(page.data(), (std::streamsize)page.size());
+            file.write(static_cast<const char*>(search_tt.raw_slots()), (std::streamsize)header.search_bytes);
+            file.write(static_cast<const char*>(endgame_tt.raw_slots()), (std::streamsize)header.endgame_bytes);
+            file.close();
+            if (!file) {
+                std::remove(temporary.c_str());
+                return false;
             }
-            std::cout << "\033[0m\n"; // Reset color
         }
+#ifdef _WIN32
+        std::remove(path.c_str()); // rename() does not replace an existing file here
+#endif
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
 
+    /**
+     * @brief Maps both kept tables back from a file written by save_hash_file().
+     * * The file must come from this version with the same table sizes (the
+     * same --hash); otherwise the tables are left as they are.
+     * @return False when the file is missing or does not match.
+     */
+    bool load_hash_file(const std::string& path, TranspositionTable& search_tt, TranspositionTable& endgame_tt) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        uint64 file_bytes = (uint64)file.tellg();
+        HashFileHeader header;
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || header.magic != HASH_FILE_MAGIC || header.version != HASH_FILE_VERSION ||
+            header.key_check != hash_file_key_check() ||
+            header.search_bytes != search_tt.size_bytes() || header.endgame_bytes != endgame_tt.size_bytes() ||
+            file_bytes != HASH_FILE_HEADER_BYTES + header.search_bytes + header.endgame_bytes) {
+            return false;
+        }
+        file.close();
 
-        int black_score = Core::count_discs(state.black_discs);
-        int white_score = Core::count_discs(state.white_discs);
-        
-        std::cout << "\nScore: \033[94m\u25CF Blue\033[0m: " << black_score 
-                  << " | \033[93m\u25CF Yellow\033[0m: " << white_score << "\n";
-        
-        std::string player_name = (state.current_player == Player::Black) ? "\033[94m\u25CF Blue (You)\033[0m" : "\033[93m\u25CB Yellow (AI)\033[0m";
-        std::cout << "Turn: " << player_name << "\n";
-        std::cout << "Last Move: " << state.last_move_coord << "\n";
+        LargePageBuffer search_slots = LargePageBuffer::from_file(path, HASH_FILE_HEADER_BYTES, header.search_bytes);
+        LargePageBuffer endgame_slots = LargePageBuffer::from_file(path, HASH_FILE_HEADER_BYTES + header.search_bytes, header.endgame_bytes);
+        if (search_slots.data() == nullptr || endgame_slots.data() == nullptr) {
+            return false;
+        }
+        search_tt.adopt(std::move(search_slots), (unsigned int)header.search_generation);
+        endgame_tt.adopt(std::move(endgame_slots), (unsigned int)header.endgame_generation);
+        return true;
     }
 
+    // Corner cells (A1, H1, A8, H8)
+    const uint64 CORNER_MASK = 0x8100000000000081ULL;
+
     /**
-     * @brief Struct to store the result of command parsing.
+     * @brief The ways the search can order the moves of a node.
      */
-    struct Command {
-        enum Type { INVALID, MOVE, UNDO, HINT, QUIT, PASS };
-        Type type = INVALID;
-        int move_index = -1; // Only used if type == MOVE
-        std::string error_message;
+    enum class MoveOrdering {
+        Natural,       // Board order (A1 to H8)
+        FastestFirst,  // Moves leaving the opponent the fewest replies first
+        ShallowSearch  // Moves with the best shallow search score first
     };
 
     /**
-     * @brief A strict UI command parser.
+     * @brief Selects the move ordering from the remaining search depth.
+     * * Near the leaves a wrong guess is cheap, so a cheap ordering is used there;
+     * higher up a shallow search pays for itself by cutting off whole subtrees.
      */
-    Command parse_command(const std::string& input, uint64 legal_moves) {
-        Command cmd;
-        std::string upper_input = input;
-        std::transform(upper_input.begin(), upper_input.end(), upper_input.begin(), ::toupper);
+    struct OrderingPolicy {
+        int fastest_first_depth = 2;  // Remaining depth from which fastest-first ordering is used
+        int shallow_search_depth = 4; // Remaining depth from which shallow search ordering is used
+        int shallow_depth = 2;        // Plies searched (including the move itself) to score a move
+
+        MoveOrdering select(int depth) const {
+            if (depth >= shallow_search_depth) return MoveOrdering::ShallowSearch;
+            if (depth >= fastest_first_depth) return MoveOrdering::FastestFirst;
+            return MoveOrdering::Natural;
+        }
+    };
+
+    /**
+     * @brief A (deep, shallow) depth pair checked by Multi-ProbCut.
+     * * Both depths have the same parity (see evaluate()).
+     */
+    struct ProbCutPair {
+        int deep_depth;
+        int shallow_depth;
+    };
+
+    const int PROBCUT_PAIR_COUNT = 8;
+    const int PROBCUT_PHASES = 4;
+    const ProbCutPair PROBCUT_PAIRS[PROBCUT_PAIR_COUNT] = {
+        {3, 1}, {4, 2}, {5, 1}, {5, 3}, {6, 2}, {6, 4}, {7, 3}, {8, 4}
+    };
+
+    /**
+     * @brief Linear model of a deep search value from a shallow one.
+     * * deep = a * shallow + b, where sigma is the standard deviation of the error.
+     */
+    struct ProbCutModel {
+        double a;
+        double b;
+        double sigma;
+    };
+
+    // Fitted offline by `othello --calibrate-probcut` (one row per pair, one column per phase)
+    const ProbCutModel PROBCUT_MODELS[PROBCUT_PAIR_COUNT][PROBCUT_PHASES] = {
+        {{1.029, -3.185, 18.917}, {1.009, -3.311, 31.917}, {1.069, -6.446, 64.211}, {1.023, -4.325, 97.711}}, // 3 from 1
+        {{1.049, -0.405, 14.116}, {1.029, 3.117, 33.435}, {1.077, -2.283, 59.404}, {1.034, 0.367, 93.765}}, // 4 from 2
+        {{1.043, -3.792, 23.167}, {1.025, -4.938, 46.754}, {1.133, -8.954, 87.637}, {1.063, 2.309, 142.310}}, // 5 from 1
+        {{1.020, -0.563, 12.058}, {1.034, -1.675, 24.357}, {1.066, -2.069, 47.861}, {1.047, 6.802, 83.199}}, // 5 from 3
+        {{1.064, -0.113, 18.104}, {1.050, 3.269, 48.817}, {1.143, -2.657, 83.703}, {1.082, 4.360, 140.489}}, // 6 from 2
+        {{1.023, 0.324, 9.857}, {1.038, 0.064, 26.821}, {1.069, -0.177, 44.291}, {1.056, 3.926, 79.398}}, // 6 from 4
+        {{1.033, 0.175, 14.614}, {1.060, -3.197, 38.668}, {1.141, -3.200, 74.030}, {1.093, 12.064, 126.118}}, // 7 from 3
+        {{1.047, 1.568, 12.930}, {1.077, -0.792, 38.879}, {1.145, 1.420, 71.712}, {1.106, 7.856, 118.111}}, // 8 from 4
+    };
+
+    /**
+     * @brief Game phase used to select a ProbCut model (0: opening ... 3: endgame).
+     */
+    int probcut_phase(const GameState& state) {
+        int total_discs = Core::count_discs(state.black_discs | state.white_discs);
+        return std::min(PROBCUT_PHASES - 1, (total_discs - 4) / 15);
+    }
+
+    /**
+     * @brief Selective search settings.
+     */
+    struct SelectiveSearch {
+        bool probcut = true;    // Enables Multi-ProbCut
+        double threshold = 1.5; // Cut when the prediction is this many sigmas outside the window
+        bool lmr = true;        // Enables late move reductions
+    };
+
+    const int SEARCH_TT_BITS = 20; // 2^20 entries (16 MB)
+    const int ETC_MIN_DEPTH = 3;   // Remaining depth from which children are looked up before searching
+    const int LMR_MIN_DEPTH = 4;         // Late move reductions from this remaining depth
+    const int LMR_FULL_DEPTH_MOVES = 3;  // Moves searched at full depth before reducing
+
+    // Detailed search statistics; build with -DYAO_SEARCH_STATS=0 to compile them out
+#ifndef YAO_SEARCH_STATS
+#define YAO_SEARCH_STATS 1
+#endif
+    constexpr bool SEARCH_STATISTICS = (YAO_SEARCH_STATS != 0);
+
+    /**
+     * @brief A statistics counter that compiles to nothing when disabled.
+     */
+    template <bool Enabled>
+    struct Counter {
+        long long value = 0;
+        void operator++(int) { ++value; }
+        void add(const Counter& other) { value += other.value; }
+        long long get() const { return value; }
+    };
+
+    template <>
+    struct Counter<false> {
+        void operator++(int) {}
+        void add(const Counter&) {}
+        long long get() const { return 0; }
+    };
+
+    using StatCounter = Counter<SEARCH_STATISTICS>;
+
+    /**
+     * @brief Nodes and time of one completed iteration of the main search thread.
+     */
+    struct IterationStats {
+        int depth = 0;
+        long long nodes = 0; // Nodes of this iteration alone
+        double seconds = 0;  // Time of this iteration alone
+    };
+
+    /**
+     * @brief Counters collected during a single search.
+     */
+    struct SearchStats {
+        long long nodes = 0;           // Nodes visited
+        double seconds = 0;            // Wall-clock time of the whole search
+        int aspiration_fail_highs = 0; // Root re-searches after the score rose above the window
+        int aspiration_fail_lows = 0;  // Root re-searches after the score fell below the window
+        long long probcut_cuts = 0;    // Nodes pruned by Multi-ProbCut
+        long long etc_cuts = 0;        // Nodes cut by a stored child bound (enhanced transposition cutoff)
+        int mtdf_passes = 0;           // Null-window root searches made by MTD(f)
+        long long lmr_reductions = 0;  // Late moves searched at reduced depth
+        long long lmr_researches = 0;  // ... and searched again at full depth after beating the window
+
+        // Compiled out unless SEARCH_STATISTICS
+        StatCounter leaf_evaluations;   // Calls to evaluate()
+        StatCounter cutoffs;            // Nodes that failed high (or low, at minimizing nodes)
+        StatCounter first_move_cutoffs; // ... on their first move
+        StatCounter tt_probes;
+        StatCounter tt_hits;
+        StatCounter tt_stores;
+        std::vector<IterationStats> iterations; // Main thread only
+
+        int window_researches() const {
+            return aspiration_fail_highs + aspiration_fail_lows;
+        }
+
+        /**
+         * @brief Adds the counters of another thread (its iterations are not kept).
+         */
+        void merge(const SearchStats& other) {
+            nodes += other.nodes;
+            aspiration_fail_highs += other.aspiration_fail_highs;
+            aspiration_fail_lows += other.aspiration_fail_lows;
+            probcut_cuts += other.probcut_cuts;
+            etc_cuts += other.etc_cuts;
+            mtdf_passes += other.mtdf_passes;
+            lmr_reductions += other.lmr_reductions;
+            lmr_researches += other.lmr_researches;
+            leaf_evaluations.add(other.leaf_evaluations);
+            cutoffs.add(other.cutoffs);
+            first_move_cutoffs.add(other.first_move_cutoffs);
+            tt_probes.add(other.tt_probes);
+            tt_hits.add(other.tt_hits);
+            tt_stores.add(other.tt_stores);
+        }
+    };
+
+    /**
+     * @brief Killer moves and history counters, kept between searches.
+     * * Killers are indexed by the number of empty cells rather than by ply, so
+     * they stay attached to the same stage of the game from one search to the
+     * next. History counters are per colour and cell.
+     */
+    struct SearchHeuristics {
+        int killers[65][2];
+        int history[2][64];
+
+        SearchHeuristics() {
+            for (auto& pair : killers) {
+                pair[0] = pair[1] = -1;
+            }
+            for (auto& row : history) {
+                std::fill(row, row + 64, 0);
+            }
+        }
+
+        /**
+         * @brief Records the move that caused a cutoff.
+         */
+        void record_cutoff(Player player, int empties, int move, int depth) {
+            if (killers[empties][0] != move) {
+                killers[empties][1] = killers[empties][0];
+                killers[empties][0] = move;
+            }
+            history[(int)player][move] += depth * depth;
+        }
+
+        bool is_killer(int empties, int move) const {
+            return killers[empties][0] == move || killers[empties][1] == move;
+        }
+
+        /**
+         * @brief Starts a new search: older history counts weigh half as much.
+         */
+        void age() {
+            for (auto& row : history) {
+                for (int& count : row) {
+                    count /= 2;
+                }
+            }
+        }
+    };
+
+    const int MAX_PLY = 128; // Deeper than any search: 60 moves plus the passes between them
+
+    /**
+     * @brief Triangular principal variation table.
+     * * Row p holds the best line found so far from ply p: moves[p][p] up to
+     * moves[p][length[p] - 1]. A pass is stored as -1.
+     */
+    struct PVTable {
+        signed char moves[MAX_PLY][MAX_PLY];
+        int length[MAX_PLY];
+
+        void clear(int ply) {
+            length[ply] = ply;
+        }
+
+        /**
+         * @brief Makes move followed by the line of ply + 1 the best line of ply.
+         */
+        void update(int ply, int move) {
+            moves[ply][ply] = (signed char)move;
+            for (int p = ply + 1; p < length[ply + 1]; ++p) {
+                moves[ply][p] = moves[ply + 1][p];
+            }
+            length[ply] = length[ply + 1];
+        }
+
+        std::vector<int> line(int ply) const {
+            return std::vector<int>(moves[ply] + ply, moves[ply] + length[ply]);
+        }
+    };
+
+    /**
+     * @brief Settings and state shared by every node of a single search.
+     * * One context exists per search thread; the transposition table and the
+     * stop flag are shared between the threads of a search.
+     */
+    struct SearchContext {
+        OrderingPolicy ordering;
+        SelectiveSearch selective;
+        TranspositionTable* tt = nullptr;        // Shared transposition table
+        SearchHeuristics* heuristics = nullptr;  // Killers and history of this thread, or nullptr
+        const std::atomic<bool>* stop = nullptr; // When set, the search unwinds without storing results
+        long long node_limit = 0;                // Stop after this many nodes (0: no limit)
+        bool has_deadline = false;
+        std::chrono::steady_clock::time_point deadline; // Stop at this time, if has_deadline
+        SearchStats stats;
+        int ply = 0;                             // Distance from the root of the node being searched
+        PVTable pv;
+        std::vector<int> previous_pv;            // Line of the previous iteration, searched first
+        bool on_previous_pv = false;             // The next node lies on previous_pv
+
+        /**
+         * @brief True once the search must unwind: stopped from outside, out of nodes or out of time.
+         * * The clock is read every 1024 nodes. Node limits alone keep a single-threaded
+         * search deterministic.
+         */
+        bool stopped() const {
+            if (stop != nullptr && stop->load(std::memory_order_relaxed)) {
+                return true;
+            }
+            if (node_limit > 0 && stats.nodes >= node_limit) {
+                return true;
+            }
+            if (has_deadline && !out_of_time_ && (stats.nodes & 1023) == 0) {
+                out_of_time_ = std::chrono::steady_clock::now() >= deadline;
+            }
+            return out_of_time_;
+        }
+
+    private:
+        mutable bool out_of_time_ = false;
+    };
+
+    /**
+     * @brief A move together with its ordering score.
+     */
+    struct ScoredMove {
+        int index = -1;
+        int score = 0; // Higher scores are searched first
+    };
+
+    int minimax_ab(GameState state, int depth, int alpha, int beta, bool maximizing_player, Player ai_player, SearchContext& ctx);
+
+    /**
+     * @brief Sorts moves by descending score.
+     * * Insertion sort: move lists are short, and equal scores keep their order.
+     */
+    void sort_moves(ScoredMove* moves, int count) {
+        for (int k = 1; k < count; ++k) {
+            ScoredMove move = moves[k];
+            int j = k - 1;
+            while (j >= 0 && moves[j].score < move.score) {
+                moves[j + 1] = moves[j];
+                --j;
+            }
+            moves[j + 1] = move;
+        }
+    }
+
+    /**
+     * @brief Counts the opponent's replies after a move (the fastest-first key).
+     * * Works on the flip mask directly instead of building the next GameState.
+     * Replies on a corner are counted twice.
+     * @param own_board The moving player's bitboard.
+     * @param opp_board The opponent's bitboard.
+     * @param move_index The 0-63 index of the valid move.
+     * @return The opponent's weighted mobility after the move.
+     */
+    int opponent_mobility_after(uint64 own_board, uint64 opp_board, int move_index) {
+        uint64 flips = Core::get_flips(own_board, opp_board, move_index);
+
+        own_board |= flips | (1ULL << move_index);
+        opp_board &= ~flips;
+
+        uint64 replies = Core::get_moves(opp_board, own_board);
+        return Core::count_discs(replies) + Core::count_discs(replies & CORNER_MASK);
+    }
+
+    // Marks a cell with no stored child score
+    const int NO_SCORE = std::numeric_limits<int>::min();
+    // Moves whose child has a stored score are searched before the others
+    const int STORED_SCORE_BONUS = 1 << 24;
+    // Killer moves come next, in the modes that do not search the moves
+    const int KILLER_SCORE = 1 << 23;
+
+    /**
+     * @brief Lists the legal moves of a node in the order they should be searched.
+     * * The table move goes first, then moves whose child has a stored score
+     * (best score first), then the rest in the order of the selected mode.
+     * Without a shallow search, killer moves go before the rest, and history
+     * counts break ties.
+     * @param state The current game state.
+     * @param legal_moves_mask The legal moves of the current player.
+     * @param depth The remaining search depth (selects the ordering mode).
+     * @param maximizing_player True if the node maximizes the evaluation.
+     * @param ai_player The player running the AI.
+     * @param ctx The search context.
+     * @param tt_move The best move stored for this node, or -1.
+     * @param child_scores Stored child scores per cell (NO_SCORE if none), or nullptr.
+     * @param moves Output array with room for 64 moves.
+     * @return The number of moves written to `moves`.
+     */
+    int order_moves(const GameState& state, uint64 legal_moves_mask, int depth, bool maximizing_player,
+                    Player ai_player, SearchContext& ctx, int tt_move, const int* child_scores, ScoredMove* moves) {
+        MoveOrdering mode = ctx.ordering.select(depth);
+        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
+        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
+        const SearchHeuristics* heuristics = (mode == MoveOrdering::ShallowSearch) ? nullptr : ctx.heuristics;
+        int empties = 64 - Core::count_discs(own_board | opp_board);
+        int count = 0;
+
+        for (int i = 0; i < 64; ++i) {
+            if (legal_moves_mask & (1ULL << i)) {
+                ScoredMove& move = moves[count++];
+                move.index = i;
+
+                if (i == tt_move) {
+                    move.score = std::numeric_limits<int>::max();
+                } else if (child_scores != nullptr && child_scores[i] != NO_SCORE) {
+                    int stored = std::max(-STORED_SCORE_BONUS + 1, std::min(STORED_SCORE_BONUS - 1, child_scores[i]));
+                    move.score = STORED_SCORE_BONUS + (maximizing_player ? stored : -stored);
+                } else if (heuristics != nullptr && heuristics->is_killer(empties, i)) {
+                    move.score = KILLER_SCORE;
+                } else if (mode == MoveOrdering::FastestFirst) {
+                    move.score = -opponent_mobility_after(own_board, opp_board, i) * 64;
+                    if (heuristics != nullptr) {
+                        move.score += std::min(63, heuristics->history[(int)state.current_player][i] >> 4);
+                    }
+                } else if (mode == MoveOrdering::ShallowSearch) {
+                    GameState next_state = Core::apply_move(state, i);
+                    int eval = minimax_ab(next_state, ctx.ordering.shallow_depth - 1, std::numeric_limits<int>::min(),
+                                          std::numeric_limits<int>::max(), !maximizing_player, ai_player, ctx);
+                    move.score = maximizing_player ? eval : -eval;
+                } else if (heuristics != nullptr) {
+                    move.score = std::min(KILLER_SCORE - 1, heuristics->history[(int)state.current_player][i]);
+                }
+            }
+        }
+
+        sort_moves(moves, count);
+        return count;
+    }
+
+    /**
+     * @brief Enhanced transposition cutoff: looks up every child before searching any of them.
+     * * A stored child bound deep enough to refute the window cuts the node
+     * immediately; any stored child score is also kept to seed the move ordering.
+     * @param state The current game state.
+     * @param legal_moves_mask The legal moves of the current player.
+     * @param depth The remaining search depth.
+     * @param alpha The alpha value.
+     * @param beta The beta value.
+     * @param maximizing_player True if the node maximizes the evaluation.
+     * @param ctx The search context.
+     * @param child_scores Receives the stored child score per cell (NO_SCORE if none).
+     * @param cut_value Set to the value to return when the node is cut.
+     * @return True if the node can be cut.
+     */
+    bool enhanced_transposition_cutoff(const GameState& state, uint64 legal_moves_mask, int depth, int alpha, int beta,
+                                       bool maximizing_player, SearchContext& ctx, int* child_scores, int& cut_value) {
+        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
+        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
+        Player next_player = switch_player(state.current_player);
+        Player ai_player = maximizing_player ? state.current_player : next_player;
+
+        for (int i = 0; i < 64; ++i) {
+            child_scores[i] = NO_SCORE;
+            if (!(legal_moves_mask & (1ULL << i))) {
+                continue;
+            }
+            uint64 flips = Core::get_flips(own_board, opp_board, i);
+            uint64 child_key = search_key(opp_board & ~flips, own_board | flips | (1ULL << i), next_player, ai_player);
+
+            TTEntry entry;
+            ctx.stats.tt_probes++;
+            if (!ctx.tt->probe(child_key, entry)) {
+                continue;
+            }
+            ctx.stats.tt_hits++;
+            child_scores[i] = entry.score;
+            if (entry.depth < depth - 1) {
+                continue;
+            }
+            // One child at least this good (for the player to move) settles the node
+            bool refutes = maximizing_player
+                ? (entry.bound != Bound::Upper && entry.score >= beta)
+                : (entry.bound != Bound::Lower && entry.score <= alpha);
+            if (refutes) {
+                ctx.stats.etc_cuts++;
+                cut_value = entry.score;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Multi-ProbCut: predicts the deep search value from shallow null-window searches.
+     * * For every depth pair matching `depth`, the fitted model turns the window
+     * into the shallow values that would put the deep value outside it with
+     * the configured confidence, and a null-window shallow search checks them.
+     * @param state The current game state.
+     * @param depth The remaining search depth.
+     * @param alpha The alpha value.
+     * @param beta The beta value.
+     * @param maximizing_player True if the node maximizes the evaluation.
+     * @param ai_player The player running the AI.
+     * @param ctx The search context.
+     * @param cut_value Set to the bound to return when the node is pruned.
+     * @return True if the node can be pruned.
+     */
+    bool probcut(const GameState& state, int depth, int alpha, int beta, bool maximizing_player,
+                 Player ai_player, SearchContext& ctx, int& cut_value) {
+        const double MIN_BOUND = std::numeric_limits<int>::min() + 1.0;
+        const double MAX_BOUND = std::numeric_limits<int>::max() - 1.0;
+        int phase = probcut_phase(state);
+
+        for (int p = 0; p < PROBCUT_PAIR_COUNT; ++p) {
+            const ProbCutPair& pair = PROBCUT_PAIRS[p];
+            const ProbCutModel& model = PROBCUT_MODELS[p][phase];
+            if (pair.deep_depth != depth || model.a <= 0) {
+                continue;
+            }
+            double margin = ctx.selective.threshold * model.sigma;
+
+            // Fail-high: the shallow value predicts deep >= beta
+            if (beta != std::numeric_limits<int>::max()) {
+                double bound = std::ceil((beta + margin - model.b) / model.a);
+                if (bound > MIN_BOUND && bound < MAX_BOUND) {
+                    int shallow_beta = (int)bound;
+                    if (minimax_ab(state, pair.shallow_depth, shallow_beta - 1, shallow_beta, maximizing_player, ai_player, ctx) >= shallow_beta) {
+                        ctx.stats.probcut_cuts++;
+                        cut_value = beta;
+                        return true;
+                    }
+                }
+            }
+
+            // Fail-low: the shallow value predicts deep <= alpha
+            if (alpha != std::numeric_limits<int>::min()) {
+                double bound = std::floor((alpha - margin - model.b) / model.a);
+                if (bound > MIN_BOUND && bound < MAX_BOUND) {
+                    int shallow_alpha = (int)bound;
+                    if (minimax_ab(state, pair.shallow_depth, shallow_alpha, shallow_alpha + 1, maximizing_player, ai_player, ctx) <= shallow_alpha) {
+                        ctx.stats.probcut_cuts++;
+                        cut_value = alpha;
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Depth reduction of the k-th ordered move of a node (late move reductions).
+     * * The first moves are searched at full depth. Later moves that leave the
+     * opponent more replies than the mover had are reduced by two plies, and by
+     * four from twice as far down the list. Reductions are even (see
+     * evaluate()); odd reductions lost games.
+     * The reduced child keeps a depth of at least 1.
+     * @param next_state The position after the move.
+     * @param k The rank of the move in the ordered list.
+     * @param move_count The number of moves of the node.
+     * @param depth The remaining depth of the node.
+     * @return The number of plies to reduce by, or 0.
+     */
+    int late_move_reduction(const GameState& next_state, int k, int move_count, int depth) {
+        if (k < LMR_FULL_DEPTH_MOVES || depth < LMR_MIN_DEPTH) {
+            return 0;
+        }
+        int opponent_mobility = Core::count_discs(Core::generate_legal_moves(next_state));
+        if (opponent_mobility <= move_count) {
+            return 0;
+        }
+        int reduction = (k >= 2 * LMR_FULL_DEPTH_MOVES) ? 4 : 2;
+        return std::min(reduction, (depth - 2) & ~1);
+    }
+
+    /**
+     * @brief Searches the child reached by move one ply deeper.
+     * * The child stays on the previous iteration's line if its parent was on it
+     * and move is the one that line played there.
+     */
+    int search_child(const GameState& child, int move, int depth, int alpha, int beta, bool maximizing_player, Player ai_player, bool parent_on_pv, SearchContext& ctx) {
+        const int ply = ctx.ply;
+        ctx.on_previous_pv = parent_on_pv && ply < (int)ctx.previous_pv.size() && ctx.previous_pv[ply] == move;
+        ctx.ply = ply + 1;
+        int eval = minimax_ab(child, depth, alpha, beta, maximizing_player, ai_player, ctx);
+        ctx.ply = ply;
+        return eval;
+    }
+
+    /**
+     * @brief Implementation of the Minimax algorithm with Alpha-Beta Pruning.
+     * * @param state The current game state.
+     * @param depth The remaining search depth.
+     * @param alpha The alpha value (maximum).
+     * @param beta The beta value (minimum).
+     * @param maximizing_player True if it's the AI's turn (maximizing), False if it's the opponent's (minimizing).
+     * @param ai_player The player running the AI (used for the final evaluation).
+     * @param ctx The search context (move ordering, selective search, transposition table and statistics).
+     * @return The best heuristic value found.
+     */
+    int minimax_ab(GameState state, int depth, int alpha, int beta, bool maximizing_player, Player ai_player, SearchContext& ctx) {
+        ctx.stats.nodes++;
+        const int ply = ctx.ply;
+        const bool on_pv = ctx.on_previous_pv;
+        ctx.on_previous_pv = false;
+        ctx.pv.clear(ply);
+        if (ctx.stopped()) {
+            return 0; // Discarded by the caller
+        }
+
+        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
+        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
+        uint64 key = 0;
+        if (depth > 0) { // Leaves are not looked up
+            key = search_key(own_board, opp_board, state.current_player, ai_player);
+            ctx.tt->prefetch(key);
+        }
+
+        uint64 legal_moves_mask = Core::generate_legal_moves(state);
+
+        // Terminal Case: Depth 0 or Game Over
+        GameState opponent_state = state;
+        opponent_state.current_player = switch_player(state.current_player);
+        uint64 opponent_legal_moves = Core::generate_legal_moves(opponent_state);
+        if (depth == 0 || ply >= MAX_PLY - 1 || Core::is_terminal(state, legal_moves_mask, opponent_legal_moves)) {
+            ctx.stats.leaf_evaluations++;
+            return evaluate(state, ai_player);
+        }
+
+        // ----------------------------------------------------
+        // Pass Case
+        if (Core::count_discs(legal_moves_mask) == 0) {
+            GameState next_state = Core::apply_pass(state);
+            int eval = search_child(next_state, -1, depth, alpha, beta, !maximizing_player, ai_player, on_pv, ctx);
+            ctx.pv.update(ply, -1);
+            return eval;
+        }
+        // ----------------------------------------------------
+
+        // Transposition table: a deep enough stored bound may settle the node or narrow the window
+        int tt_move = -1;
+        TTEntry entry;
+        ctx.stats.tt_probes++;
+        if (ctx.tt->probe(key, entry)) {
+            ctx.stats.tt_hits++;
+            tt_move = entry.best_move;
+            if (entry.depth >= depth) {
+                if (entry.bound == Bound::Exact) {
+                    return entry.score;
+                } else if (entry.bound == Bound::Lower) {
+                    alpha = std::max(alpha, entry.score);
+                } else {
+                    beta = std::min(beta, entry.score);
+                }
+                if (alpha >= beta) {
+                    return entry.score;
+                }
+            }
+        }
+        int window_alpha = alpha;
+        int window_beta = beta;
+
+        int child_scores[64];
+        bool use_etc = depth >= ETC_MIN_DEPTH;
+        int cut_value;
+        if (use_etc && enhanced_transposition_cutoff(state, legal_moves_mask, depth, alpha, beta, maximizing_player, ctx, child_scores, cut_value)) {
+            return cut_value;
+        }
+
+        if (ctx.selective.probcut && probcut(state, depth, alpha, beta, maximizing_player, ai_player, ctx, cut_value)) {
+            return cut_value;
+        }
+
+        // Without a stored move, the previous iteration's line is tried first
+        if (tt_move < 0 && on_pv && ply < (int)ctx.previous_pv.size()) {
+            tt_move = ctx.previous_pv[ply];
+        }
+
+        ScoredMove moves[64];
+        int move_count = order_moves(state, legal_moves_mask, depth, maximizing_player, ai_player, ctx,
+                                     tt_move, use_etc ? child_scores : nullptr, moves);
+        int best_eval;
+        int best_move = -1;
+        ctx.pv.clear(ply); // Shallow searches for ordering and ProbCut reuse this row
+
+        // Late moves are first tried at reduced depth with a null window, except on the
+        // previous iteration's line; only those that beat the window are searched in full.
+        bool reduce_late_moves = ctx.selective.lmr && !on_pv;
+
+        if (maximizing_player) { // AI Player
+            best_eval = std::numeric_limits<int>::min();
+
+            for (int k = 0; k < move_count; ++k) {
+                GameState next_state = Core::apply_move(state, moves[k].index);
+                int reduction = reduce_late_moves ? late_move_reduction(next_state, k, move_count, depth) : 0;
+                int eval = 0;
+                if (reduction > 0) {
+                    ctx.stats.lmr_reductions++;
+                    eval = search_child(next_state, moves[k].index, depth - 1 - reduction, alpha, alpha + 1, false, ai_player, on_pv, ctx);
+                }
+                if (reduction == 0 || (eval > alpha && !ctx.stopped())) {
+                    ctx.stats.lmr_researches += (reduction > 0);
+                    eval = search_child(next_state, moves[k].index, depth - 1, alpha, beta, false, ai_player, on_pv, ctx);
+                }
+                if (ctx.stopped()) {
+                    return 0; // Incomplete: nothing is stored
+                }
+                if (eval > alpha) {
+                    ctx.pv.update(ply, moves[k].index);
+                }
+                if (eval > best_eval) {
+                    best_eval = eval;
+                    best_move = moves[k].index;
+                }
+                alpha = std::max(alpha, best_eval);
+                if (beta <= alpha) {
+                    ctx.stats.cutoffs++;
+                    if (k == 0) {
+                        ctx.stats.first_move_cutoffs++;
+                    }
+                    break; // Pruning
+                }
+            }
+        } else { // Opponent Player
+            best_eval = std::numeric_limits<int>::max();
+
+            for (int k = 0; k < move_count; ++k) {
+                GameState next_state = Core::apply_move(state, moves[k].index);
+                int reduction = reduce_late_moves ? late_move_reduction(next_state, k, move_count, depth) : 0;
+                int eval = 0;
+                if (reduction > 0) {
+                    ctx.stats.lmr_reductions++;
+                    eval = search_child(next_state, moves[k].index, depth - 1 - reduction, beta - 1, beta, true, ai_player, on_pv, ctx);
+                }
+                if (reduction == 0 || (eval < beta && !ctx.stopped())) {
+                    ctx.stats.lmr_researches += (reduction > 0);
+                    eval = search_child(next_state, moves[k].index, depth - 1, alpha, beta, true, ai_player, on_pv, ctx);
+                }
+                if (ctx.stopped()) {
+                    return 0; // Incomplete: nothing is stored
+                }
+                if (eval < beta) {
+                    ctx.pv.update(ply, moves[k].index);
+                }
+                if (eval < best_eval) {
+                    best_eval = eval;
+                    best_move = moves[k].index;
+                }
+                beta = std::min(beta, best_eval);
+                if (beta <= alpha) {
+                    ctx.stats.cutoffs++;
+                    if (k == 0) {
+                        ctx.stats.first_move_cutoffs++;
+                    }
+                    break; // Pruning
+                }
+            }
+        }
+
+        if (beta <= alpha && ctx.heuristics != nullptr) {
+            ctx.heuristics->record_cutoff(state.current_player, 64 - Core::count_discs(own_board | opp_board), best_move, depth);
+        }
+
+        Bound bound = (best_eval <= window_alpha) ? Bound::Upper : (best_eval >= window_beta) ? Bound::Lower : Bound::Exact;
+        ctx.tt->store(key, depth, best_eval, bound, best_move);
+        ctx.stats.tt_stores++;
+        return best_eval;
+    }
+
+    // Half-width of the first aspiration window around the previous iteration's score
+    const int ASPIRATION_WINDOW = 32;
+    // Depth limit of searches bounded by a node or time budget instead
+    const int MAX_SEARCH_DEPTH = 60;
+
+    /**
+     * @brief A root move with its exact score, as ranked by a multi-PV search.
+     */
+    struct RankedMove {
+        int move = -1;
+        int score = 0;
+        std::vector<int> pv; // Expected line of play, starting with move
+    };
+
+    /**
+     * @brief The result of a root search.
+     */
+    struct SearchResult {
+        int best_move = -1; // 0-63, or -1 for a pass
+        int score = 0;      // Evaluation of the best move for the player to move
+        int depth = 0;      // Depth of the last completed iteration
+        std::vector<int> pv; // Expected line of play, starting with best_move
+        std::vector<RankedMove> ranked; // With SearchLimits::multi_pv > 1: the best moves, best first
+        SearchStats stats;
+    };
+
+    /**
+     * @brief How the root finds the value of each iteration.
+     */
+    enum class RootSearch {
+        Aspiration, // A window around the previous score, widened when the score falls outside
+        MTDf        // Null-window searches converging on the value (MTD(f))
+    };
+
+    /**
+     * @brief Limits and resources of a search.
+     */
+    struct SearchLimits {
+        int depth = 5;        // Maximum iterative deepening depth
+        long long nodes = 0;  // Node budget of the main thread (0: none); deterministic with one thread
+        int time_ms = 0;      // Time budget in milliseconds (0: none)
+        int threads = 1;      // Search threads sharing one transposition table (Lazy SMP)
+        int multi_pv = 1;     // Number of best root moves given exact scores
+        RootSearch root_search = RootSearch::Aspiration;
+        SelectiveSearch selective;
+        TranspositionTable* tt = nullptr; // A table kept by the caller between searches, or nullptr for a fresh one
+        SearchHeuristics* heuristics = nullptr; // Killers and history kept by the caller, or nullptr for fresh ones
+        const std::atomic<bool>* stop = nullptr; // When set, the search returns its last completed iteration
+        std::function<void(const SearchResult&)> on_iteration; // Called after each completed iteration
+    };
+
+    /**
+     * @brief Builds the expected line of play from the root.
+     * * The given line is replayed first, then the table's best moves are
+     * followed until max_length moves, a missing entry or an illegal move.
+     * @param state The root game state.
+     * @param line The start of the line, as found by the search; -1 is a pass.
+     * @param tt The table of the search.
+     * @param max_length The maximum number of moves.
+     */
+    std::vector<int> principal_variation(const GameState& state, const std::vector<int>& line, const TranspositionTable& tt, int max_length) {
+        std::vector<int> pv;
+        Player ai_player = state.current_player;
+        GameState position = state;
+        while ((int)pv.size() < max_length) {
+            uint64 legal_moves = Core::generate_legal_moves(position);
+            uint64 own_board = (position.current_player == Player::Black) ? position.black_discs : position.white_discs;
+            uint64 opp_board = (position.current_player == Player::Black) ? position.white_discs : position.black_discs;
+            int move = -1;
+            TTEntry entry;
+            if (pv.size() < line.size()) {
+                move = line[pv.size()];
+            } else if (legal_moves != 0) {
+                if (!tt.probe(search_key(own_board, opp_board, position.current_player, ai_player), entry)) {
+                    break;
+                }
+                move = entry.best_move;
+            }
+
+            if (move < 0) {
+                GameState opponent_state = position;
+                opponent_state.current_player = switch_player(position.current_player);
+                if (legal_moves != 0 || Core::generate_legal_moves(opponent_state) == 0) {
+                    break;
+                }
+                position = Core::apply_pass(position);
+            } else {
+                if (!(legal_moves & (1ULL << move))) {
+                    break;
+                }
+                position = Core::apply_move(position, move);
+            }
+            pv.push_back(move);
+        }
+        return pv;
+    }
+
+    /**
+     * @brief Searches every root move once with the given window.
+     * * The best move is moved to the front of `moves`, so the next iteration searches it first.
+     * @param state The root game state.
+     * @param moves The root moves, in search order.
+     * @param move_count The number of root moves.
+     * @param depth The search depth.
+     * @param alpha The lower bound of the window.
+     * @param beta The upper bound of the window.
+     * @param ctx The search context.
+     * @return The best value found; at or below alpha on a fail-low, at or above beta on a fail-high.
+     * Meaningless if the search was stopped.
+     */
+    int search_root(const GameState& state, ScoredMove* moves, int move_count, int depth, int alpha, int beta, SearchContext& ctx) {
+        int best_eval = std::numeric_limits<int>::min();
+        int best_k = 0;
+        ctx.ply = 0;
+        ctx.pv.clear(0);
+
+        for (int k = 0; k < move_count; ++k) {
+            GameState next_state = Core::apply_move(state, moves[k].index);
+
+            // Call Minimax on the next level (minimizer)
+            int eval = search_child(next_state, moves[k].index, depth - 1, alpha, beta, false, state.current_player, true, ctx);
+            if (ctx.stopped()) {
+                return best_eval;
+            }
+
+            if (eval > alpha || k == 0) {
+                ctx.pv.update(0, moves[k].index);
+            }
+            if (eval > best_eval) {
+                best_eval = eval;
+                best_k = k;
+            }
+            alpha = std::max(alpha, eval);
+            if (beta <= alpha) {
+                break; // Fail-high
+            }
+        }
+
+        std::rotate(moves, moves + best_k, moves + best_k + 1);
+        return best_eval;
+    }
+
+    /**
+     * @brief MTD(f): finds the value of one iteration with null-window root searches.
+     * * Each pass proves the value above or below a bound; the table keeps the
+     * bounds of earlier passes, so later passes revisit little of the tree.
+     * @param state The root game state.
+     * @param moves The root moves, in search order; the best move ends up in front.
+     * @param move_count The number of root moves.
+     * @param depth The search depth.
+     * @param guess The first bound to test, usually an earlier iteration's score.
+     * @param ctx The search context.
+     * @return The value of the root. Meaningless if the search was stopped.
+     */
+    int mtdf_root(const GameState& state, ScoredMove* moves, int move_count, int depth, int guess, SearchContext& ctx) {
+        int lower = std::numeric_limits<int>::min();
+        int upper = std::numeric_limits<int>::max();
+        int value = guess;
+        int best_move = moves[0].index;
+
+        while (lower < upper) {
+            int beta = (value == lower) ? value + 1 : value;
+            value = search_root(state, moves, move_count, depth, beta - 1, beta, ctx);
+            if (ctx.stopped()) {
+                return value;
+            }
+            ctx.stats.mtdf_passes++;
+            if (value < beta) {
+                upper = value;
+            } else {
+                lower = value;
+                best_move = moves[0].index; // The move that reached beta
+            }
+        }
+
+        // A last pass that failed low leaves the moves ordered by upper bounds
+        ScoredMove* best = std::find_if(moves, moves + move_count, [&](const ScoredMove& move) {
+            return move.index == best_move;
+        });
+        std::rotate(moves, best, best + 1);
+        return value;
+    }
+
+    /**
+     * @brief Finds the best `count` root moves with exact scores (multi-PV).
+     * * Each move is searched with alpha at the score of the count-th best move so
+     * far and no upper bound: a move that fails low cannot enter the ranking,
+     * and a move that beats alpha gets its exact score. All moves but the last
+     * ranked ones are thus searched with the same cutoffs as a single best move.
+     * @param state The root game state.
+     * @param moves The root moves, in search order; they end up in ranking order.
+     * @param move_count The number of root moves.
+     * @param depth The search depth.
+     * @param count The number of moves to rank.
+     * @param ctx The search context.
+     * @param ranked Receives the ranking, best first.
+     * @return The score of the best move. Meaningless if the search was stopped.
+     */
+    int multi_pv_root(const GameState& state, ScoredMove* moves, int move_count, int depth, int count, SearchContext& ctx,
+                      std::vector<RankedMove>& ranked) {
+        ranked.clear();
+        ctx.ply = 0;
+        for (int k = 0; k < move_count; ++k) {
+            int alpha = ((int)ranked.size() < count) ? std::numeric_limits<int>::min() : ranked.back().score;
+            GameState next_state = Core::apply_move(state, moves[k].index);
+            int eval = search_child(next_state, moves[k].index, depth - 1, alpha, std::numeric_limits<int>::max(),
+                                    false, state.current_player, true, ctx);
+            if (ctx.stopped()) {
+                return 0;
+            }
+            moves[k].score = eval;
+
+            if (eval > alpha) {
+                RankedMove line;
+                line.move = moves[k].index;
+                line.score = eval;
+                line.pv = ctx.pv.line(1);
+                line.pv.insert(line.pv.begin(), line.move);
+                auto position = std::upper_bound(ranked.begin(), ranked.end(), line, [](const RankedMove& a, const RankedMove& b) {
+                    return a.score > b.score;
+                });
+                ranked.insert(position, line);
+                if ((int)ranked.size() > count) {
+                    ranked.pop_back();
+                }
+            }
+        }
+
+        sort_moves(moves, move_count);
+        return ranked.front().score;
+    }
+
+    /**
+     * @brief Iterative deepening with aspiration windows for one search thread.
+     * * Each iteration after the second starts with a narrow window around a
+     * previous score. When the score falls outside it, the failed side of the
+     * window is widened (doubling each time) and the iteration is searched again.
+     * With MTD(f), the same previous score is the first bound tested instead.
+     * Multi-PV iterations are searched with open windows.
+     * An iteration interrupted by the stop flag is discarded.
+     * @param state The root game state.
+     * @param moves The root moves, in search order.
+     * @param move_count The number of root moves.
+     * @param max_depth The depth of the last iteration.
+     * @param root_search How each iteration's value is found.
+     * @param multi_pv The number of best moves to rank; 1 for the best move only.
+     * @param ctx The search context of this thread.
+     * @param result Receives the result of each completed iteration.
+     * @param on_iteration If set, called with the result after each completed iteration.
+     */
+    void iterative_deepening(const GameState& state, ScoredMove* moves, int move_count, int max_depth, RootSearch root_search,
+                             int multi_pv, SearchContext& ctx, SearchResult& result, const std::function<void(const SearchResult&)>& on_iteration) {
+        const long long MIN_SCORE = std::numeric_limits<int>::min();
+        const long long MAX_SCORE = std::numeric_limits<int>::max();
+        auto clamp_score = [&](long long value) {
+            return (int)std::max(MIN_SCORE, std::min(MAX_SCORE, value));
+        };
+
+        // Each window is centred on the score of the last iteration with the same parity
+        int iteration_scores[2] = {0, 0};
+
+        auto iteration_start = std::chrono::steady_clock::now();
+        long long iteration_start_nodes = ctx.stats.nodes;
+
+        for (int d = 1; d <= max_depth; ++d) {
+            long long delta = ASPIRATION_WINDOW;
+            long long center = iteration_scores[d % 2];
+            int alpha = (d <= 2) ? (int)MIN_SCORE : clamp_score(center - delta);
+            int beta = (d <= 2) ? (int)MAX_SCORE : clamp_score(center + delta);
+            if (root_search == RootSearch::MTDf) {
+                alpha = (int)MIN_SCORE;
+                beta = (int)MAX_SCORE;
+            }
+
+            while (true) {
+                std::vector<RankedMove> ranked;
+                int eval = (multi_pv > 1) ? multi_pv_root(state, moves, move_count, d, multi_pv, ctx, ranked)
+                    : (root_search == RootSearch::MTDf) ? mtdf_root(state, moves, move_count, d, (int)center, ctx)
+                    : search_root(state, moves, move_count, d, alpha, beta, ctx);
+                if (ctx.stopped()) {
+                    return;
+                }
+
+                if (multi_pv > 1) {
+                    alpha = (int)MIN_SCORE;
+                    beta = (int)MAX_SCORE;
+                }
+                if (eval <= alpha && alpha != MIN_SCORE) {
+                    ctx.stats.aspiration_fail_lows++;
+                    delta *= 2;
+                    alpha = clamp_score((long long)eval - delta);
+                } else if (eval >= beta && beta != MAX_SCORE) {
+                    ctx.stats.aspiration_fail_highs++;
+                    delta *= 2;
+                    beta = clamp_score((long long)eval + delta);
+                } else {
+                    result.best_move = moves[0].index;
+                    result.score = eval;
+                    result.depth = d;
+                    iteration_scores[d % 2] = eval;
+                    // The collected line is exact up to the first cut; the table extends it
+                    std::vector<int> line = (multi_pv > 1) ? ranked.front().pv : ctx.pv.line(0);
+                    if (line.empty() || line[0] != result.best_move) {
+                        line.assign(1, result.best_move);
+                    }
+                    result.pv = principal_variation(state, line, *ctx.tt, d);
+                    ctx.previous_pv = result.pv;
+                    for (RankedMove& ranked_move : ranked) {
+                        ranked_move.pv = principal_variation(state, ranked_move.pv, *ctx.tt, d);
+                    }
+                    result.ranked = ranked;
+                    if (SEARCH_STATISTICS) {
+                        auto now = std::chrono::steady_clock::now();
+                        IterationStats iteration;
+                        iteration.depth = d;
+                        iteration.nodes = ctx.stats.nodes - iteration_start_nodes;
+                        iteration.seconds = std::chrono::duration<double>(now - iteration_start).count();
+                        ctx.stats.iterations.push_back(iteration);
+                        iteration_start = now;
+                        iteration_start_nodes = ctx.stats.nodes;
+                    }
+                    if (on_iteration) {
+                        result.stats = ctx.stats;
+                        on_iteration(result);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Root search, optionally parallel (Lazy SMP).
+     * * Every thread runs its own iterative deepening on the same shared
+     * transposition table. Helper threads start from a rotated root move order,
+     * and every other helper aims one ply deeper, so they fill the table with
+     * entries the main thread has not searched yet. When the main thread
+     * finishes, the helpers are stopped; a helper result is only used if it
+     * completed a deeper iteration than the main thread. When the search is
+     * stopped, or runs out of its node or time budget, the last completed
+     * iteration is returned.
+     * @param state The current game state.
+     * @param limits The search depth and thread count.
+     * @return The best move, its score and the statistics of all threads.
+     */
+    SearchResult search(const GameState& state, const SearchLimits& limits) {
+        auto start = std::chrono::steady_clock::now();
+        SearchResult result;
+        uint64 legal_moves_mask = Core::generate_legal_moves(state);
+
+        if (Core::count_discs(legal_moves_mask) == 0) {
+            return result; // Pass
+        }
+
+        ScoredMove moves[64];
+        int move_count = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (legal_moves_mask & (1ULL << i)) {
+                moves[move_count++].index = i;
+            }
+        }
+
+        std::unique_ptr<TranspositionTable> fresh_tt;
+        TranspositionTable* tt = limits.tt;
+        if (tt == nullptr) {
+            fresh_tt.reset(new TranspositionTable(SEARCH_TT_BITS));
+            tt = fresh_tt.get();
+        }
+        std::atomic<bool> stop(false);
+        int helper_count = std::max(1, limits.threads) - 1;
+
+        SearchHeuristics fresh_heuristics;
+        SearchHeuristics* heuristics = (limits.heuristics != nullptr) ? limits.heuristics : &fresh_heuristics;
+
+        // Helpers start from a copy of the killers and history; only the main thread's are kept
+        std::vector<SearchContext> helper_ctx(helper_count);
+        std::vector<SearchHeuristics> helper_heuristics(helper_count, *heuristics);
+        std::vector<SearchResult> helper_results(helper_count);
+        // Each helper's root moves, rotated before any thread starts: the main thread reorders `moves` as it searches
+        std::vector<std::array<ScoredMove, 64>> helper_moves(helper_count);
+        std::vector<std::thread> helpers;
+        for (int t = 0; t < helper_count; ++t) {
+            helper_ctx[t].tt = tt;
+            helper_ctx[t].heuristics = &helper_heuristics[t];
+            helper_ctx[t].stop = &stop;
+            helper_ctx[t].selective = limits.selective;
+            ScoredMove* own_moves = helper_moves[t].data();
+            std::copy(moves, moves + move_count, own_moves);
+            std::rotate(own_moves, own_moves + (t + 1) % move_count, own_moves + move_count);
+            helpers.emplace_back([&, t, own_moves]() {
+                int helper_depth = limits.depth + (t % 2 == 0 ? 1 : 0);
+                iterative_deepening(state, own_moves, move_count, helper_depth, limits.root_search, limits.multi_pv, helper_ctx[t], helper_results[t], nullptr);
+            });
+        }
+
+        // Until the first iteration completes, any legal move beats none
+        result.best_move = moves[0].index;
+        result.pv.assign(1, result.best_move);
+
+        SearchContext ctx;
+        ctx.tt = tt;
+        ctx.heuristics = heuristics;
+        ctx.stop = limits.stop;
+        ctx.selective = limits.selective;
+        ctx.node_limit = limits.nodes;
+        if (limits.time_ms > 0) {
+            ctx.has_deadline = true;
+            ctx.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.time_ms);
+        }
+        iterative_deepening(state, moves, move_count, limits.depth, limits.root_search, limits.multi_pv, ctx, result, limits.on_iteration);
+
+        stop.store(true, std::memory_order_relaxed);
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+
+        SearchStats stats = ctx.stats;
+        for (int t = 0; t < helper_count; ++t) {
+            if (helper_results[t].depth > result.depth) {
+                result = helper_results[t];
+            }
+            stats.merge(helper_ctx[t].stats);
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.stats = stats;
+        return result;
+    }
+
+    const int PONDER_PREDICTED_DEPTH = 8; // Depth given to the expected reply before pondering the others
+
+    /**
+     * @brief Searches while the opponent thinks (pondering).
+     * * First deepens the position after the reply the last search expected,
+     * then runs iterative deepening over all of the opponent's replies, scored
+     * for `ai_player`, into the caller's table. The search after the opponent's
+     * move then finds most of its tree already there, whichever reply was
+     * played. Returns when `stop` is set or the game's end is within reach.
+     * @param state The position with the opponent to move.
+     * @param ai_player The player who moves after the opponent.
+     * @param predicted_reply The opponent's move in the last principal variation, or -1.
+     * @param tt The table the next search will use.
+     * @param heuristics The killers and history the next search will use.
+     * @param selective The selective search of the next search, so the table gets the same kind of results.
+     * @param stop Set by the caller when the opponent has moved.
+     */
+    void ponder(const GameState& state, Player ai_player, int predicted_reply, TranspositionTable& tt,
+                SearchHeuristics& heuristics, SelectiveSearch selective, const std::atomic<bool>& stop) {
+        SearchContext ctx;
+        ctx.tt = &tt;
+        ctx.heuristics = &heuristics;
+        ctx.selective = selective;
+        ctx.stop = &stop;
+        int empties = 64 - Core::count_discs(state.black_discs | state.white_discs);
+        if (predicted_reply >= 0 && (Core::generate_legal_moves(state) & (1ULL << predicted_reply))) {
+            GameState expected = Core::apply_move(state, predicted_reply);
+            bool ai_to_move = (expected.current_player == ai_player);
+            for (int depth = 1; depth <= std::min(PONDER_PREDICTED_DEPTH, empties - 1) && !ctx.stopped(); ++depth) {
+                minimax_ab(expected, depth, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+                           ai_to_move, ai_player, ctx);
+            }
+        }
+        bool maximizing_player = (state.current_player == ai_player);
+        for (int depth = 1; depth <= empties && !ctx.stopped(); ++depth) {
+            minimax_ab(state, depth, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(),
+                       maximizing_player, ai_player, ctx);
+        }
+    }
+
+    /**
+     * @brief Finds the best move for the AI (main AI function).
+     * * @param state The current game state.
+     * @param depth The search depth.
+     * @return The index of the best move (0-63), or -1 for a pass.
+     */
+    int find_best_move(const GameState& state, int depth) {
+        SearchLimits limits;
+        limits.depth = depth;
+        return search(state, limits).best_move;
+    }
+
+    // ---------------------------------------------------------------------
+    // Exact endgame solver
+    // - Negamax on raw (player to move, opponent) bitboards.
+    // - Scores are final disc differences for the player to move; the
+    //   evaluation function is never called.
+    // ---------------------------------------------------------------------
+
+    const int ENDGAME_TT_BITS = 18;             // 2^18 entries: endgame trees repeat fewer positions
+    const int ENDGAME_TT_MIN_EMPTIES = 7;       // Closer to the end, solving is cheaper than a table lookup
+    const int ENDGAME_ORDERING_MIN_EMPTIES = 7; // Fastest-first ordering from this many empties
+    const int ENDGAME_ETC_MIN_EMPTIES = 10;     // Children are looked up before searching from this many empties
+    const int ENDGAME_SCORE_BOUND = 65;         // Beyond any final disc difference
+    const int ENDGAME_SPLIT_MIN_EMPTIES = 12;   // Smaller subtrees are not worth sharing between threads
+    const int ENDGAME_LARGE_TT_BITS = 22;       // 2^22 entries (64 MB) for parallel and very deep solves
+    const int ENDGAME_LARGE_TT_EMPTIES = 20;    // Solves from this many empties use the large table
+
+    /**
+     * @brief A node whose remaining moves are shared between threads (Young Brothers Wait).
+     * * Created once the eldest move has been searched without a cutoff. The
+     * owner and any helpers take the remaining moves one at a time. The split
+     * point lives on the owner's stack, so the owner returns only after every
+     * helper has left.
+     */
+    struct SplitPoint {
+        uint64 own_board = 0;
+        uint64 opp_board = 0;
+        int beta = 0;
+        const ScoredMove* moves = nullptr;
+        int move_count = 0;
+        const SplitPoint* parent = nullptr; // The split point the owner is searching under
+
+        std::mutex lock; // Guards the fields below
+        int next_move = 0;
+        int alpha = 0;
+        int best_score = 0;
+        int best_move = -1;
+        int helpers = 0;                 // Threads other than the owner working here
+        std::atomic<bool> cutoff{false}; // A move reached beta: the other moves are not needed
+    };
+
+    struct EndgamePool;
+
+    /**
+     * @brief When an endgame solve gives up before proving its value.
+     */
+    struct SolveBudget {
+        const std::atomic<bool>* stop = nullptr; // Set from outside to abandon the solve
+        int time_ms = 0;                         // Time budget in milliseconds (0: none)
+    };
+
+    /**
+     * @brief The budget of a running solve, shared by its threads.
+     * * Each thread reads the stop flag and the clock every 1024 of its nodes;
+     * once either runs out, every thread unwinds as after a cutoff.
+     */
+    struct SolveAbort {
+        const std::atomic<bool>* stop = nullptr;
+        bool has_deadline = false;
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<bool> expired{false};
+
+        void poll() {
+            if ((stop != nullptr && stop->load(std::memory_order_relaxed)) ||
+                (has_deadline && std::chrono::steady_clock::now() >= deadline)) {
+                expired.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * @brief Per-thread state of an endgame solve.
+     */
+    struct EndgameContext {
+        TranspositionTable* tt = nullptr; // Shared between the threads of a solve
+        long long nodes = 0;
+        EndgamePool* pool = nullptr;      // nullptr for a single-threaded solve
+        int thread_id = 0;
+        const SplitPoint* split = nullptr; // Innermost split point this thread is searching under
+        SolveAbort* abort = nullptr;       // nullptr for a solve without a budget
+
+        /**
+         * @brief True if the solve ran out of its budget, or a cutoff at an enclosing
+         * split point made the current subtree useless.
+         */
+        bool cancelled() const {
+            if (abort != nullptr && abort->expired.load(std::memory_order_relaxed)) {
+                return true;
+            }
+            for (const SplitPoint* sp = split; sp != nullptr; sp = sp->parent) {
+                if (sp->cutoff.load(std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    /**
+     * @brief The threads of a parallel endgame solve and their split points.
+     * * Each thread publishes its split points in its own deque, newest (smallest)
+     * at the back. Idle threads steal from the front of other threads' deques,
+     * where the largest subtrees are.
+     */
+    struct EndgamePool {
+        struct Worker {
+            std::mutex lock; // Guards split_points
+            std::deque<SplitPoint*> split_points;
+            EndgameContext ctx;
+        };
+
+        std::vector<Worker> workers; // Worker 0 is the thread that started the solve
+        std::atomic<int> idle_threads{0}; // Threads looking for work; nodes are only split while some are
+        std::atomic<bool> stop{false};
+
+        // Idle helpers sleep until a split point is published or the solve ends
+        std::mutex work_lock;
+        std::condition_variable work_ready;
+        long long published = 0; // Split points published so far; guarded by work_lock
+
+        void publish() {
+            std::lock_guard<std::mutex> guard(work_lock);
+            ++published;
+            work_ready.notify_all();
+        }
+
+        void finish() {
+            std::lock_guard<std::mutex> guard(work_lock);
+            stop.store(true, std::memory_order_relaxed);
+            work_ready.notify_all();
+        }
+
+        EndgamePool(int threads, TranspositionTable* tt) : workers(threads) {
+            for (int t = 0; t < threads; ++t) {
+                workers[t].ctx.tt = tt;
+                workers[t].ctx.pool = this;
+                workers[t].ctx.thread_id = t;
+            }
+        }
+    };
+
+    /**
+     * @brief Final disc difference for the player to move (empty cells are not counted).
+     */
+    int final_score(uint64 own_board, uint64 opp_board) {
+        return Core::count_discs(own_board) - Core::count_discs(opp_board);
+    }
+
+    // Quadrants of the board, for region parity
+    const uint64 QUADRANT_MASKS[4] = {
+        0x000000000F0F0F0FULL, 0x00000000F0F0F0F0ULL, 0x0F0F0F0F00000000ULL, 0xF0F0F0F000000000ULL
+    };
+
+    /**
+     * @brief True if the cell lies in a quadrant with an odd number of empty cells.
+     * * Playing into odd regions first tends to leave the last move of each
+     * region to the player to move.
+     */
+    bool in_odd_region(int index, uint64 empty_board) {
+        for (int q = 0; q < 4; ++q) {
+            if (QUADRANT_MASKS[q] & (1ULL << index)) {
+                return Core::count_discs(empty_board & QUADRANT_MASKS[q]) & 1;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Stable-sorts a few empty cells so the ones in odd regions come first.
+     */
+    void order_by_parity(int* squares, int count, uint64 empty_board) {
+        std::stable_partition(squares, squares + count, [&](int index) {
+            return in_odd_region(index, empty_board);
+        });
+    }
+
+    /**
+     * @brief Solves the last empty cell.
+     * * Only counts the flips; the final position is never built.
+     * @param own_board The moving player's bitboard.
+     * @param opp_board The opponent's bitboard.
+     * @param x The last empty cell.
+     * @param ctx The endgame context.
+     * @return The final disc difference for the player to move.
+     */
+    int solve_last_1(uint64 own_board, uint64 opp_board, int x, EndgameContext& ctx) {
+        ctx.nodes++;
+        int score = final_score(own_board, opp_board);
+
+        int flipped = Core::count_discs(Core::get_flips(own_board, opp_board, x));
+        if (flipped > 0) {
+            return score + 2 * flipped + 1;
+        }
+        // The player to move passes; the opponent may still take the cell
+        flipped = Core::count_discs(Core::get_flips(opp_board, own_board, x));
+        if (flipped > 0) {
+            return score - 2 * flipped - 1;
+        }
+        return score;
+    }
+
+    /**
+     * @brief Solves the last two empty cells (x1, x2).
+     * * @return The final disc difference for the player to move (fail-soft).
+     */
+    int solve_last_2(uint64 own_board, uint64 opp_board, int alpha, int beta, int x1, int x2, bool passed, EndgameContext& ctx) {
+        ctx.nodes++;
+        int best_score = -ENDGAME_SCORE_BOUND;
+
+        uint64 flips = Core::get_flips(own_board, opp_board, x1);
+        if (flips != 0) {
+            best_score = -solve_last_1(opp_board & ~flips, own_board | flips | (1ULL << x1), x2, ctx);
+            if (best_score >= beta) {
+                return best_score;
+            }
+        }
+        flips = Core::get_flips(own_board, opp_board, x2);
+        if (flips != 0) {
+            best_score = std::max(best_score, -solve_last_1(opp_board & ~flips, own_board | flips | (1ULL << x2), x1, ctx));
+        }
+
+        if (best_score == -ENDGAME_SCORE_BOUND) { // No legal move
+            if (passed) {
+                return final_score(own_board, opp_board);
+            }
+            return -solve_last_2(opp_board, own_board, -beta, -alpha, x1, x2, true, ctx);
+        }
+        return best_score;
+    }
+
+    /**
+     * @brief Solves the last three empty cells, odd regions first.
+     * * @return The final disc difference for the player to move (fail-soft).
+     */
+    int solve_last_3(uint64 own_board, uint64 opp_board, int alpha, int beta, int x1, int x2, int x3, bool passed, EndgameContext& ctx) {
+        ctx.nodes++;
+        int squares[3] = {x1, x2, x3};
+        if (!passed) {
+            order_by_parity(squares, 3, ~(own_board | opp_board));
+        }
+
+        int best_score = -ENDGAME_SCORE_BOUND;
+        for (int k = 0; k < 3; ++k) {
+            int x = squares[k];
+            uint64 flips = Core::get_flips(own_board, opp_board, x);
+            if (flips == 0) {
+                continue;
+            }
+            int score = -solve_last_2(opp_board & ~flips, own_board | flips | (1ULL << x), -beta, -alpha,
+                                      squares[k == 0 ? 1 : 0], squares[k == 2 ? 1 : 2], false, ctx);
+            if (score > best_score) {
+                best_score = score;
+                alpha = std::max(alpha, score);
+                if (alpha >= beta) {
+                    return best_score; // Pruning
+                }
+            }
+        }
+
+        if (best_score == -ENDGAME_SCORE_BOUND) { // No legal move
+            if (passed) {
+                return final_score(own_board, opp_board);
+            }
+            return -solve_last_3(opp_board, own_board, -beta, -alpha, squares[0], squares[1], squares[2], true, ctx);
+        }
+        return best_score;
+    }
+
+    /**
+     * @brief Solves the last four empty cells, odd regions first.
+     * * @return The final disc difference for the player to move (fail-soft).
+     */
+    int solve_last_4(uint64 own_board, uint64 opp_board, int alpha, int beta, int x1, int x2, int x3, int x4, bool passed, EndgameContext& ctx) {
+        ctx.nodes++;
+        int squares[4] = {x1, x2, x3, x4};
+        if (!passed) {
+            order_by_parity(squares, 4, ~(own_board | opp_board));
+        }
+
+        int best_score = -ENDGAME_SCORE_BOUND;
+        for (int k = 0; k < 4; ++k) {
+            int x = squares[k];
+            uint64 flips = Core::get_flips(own_board, opp_board, x);
+            if (flips == 0) {
+                continue;
+            }
+            // The three remaining cells, in their current order
+            int rest[3];
+            for (int j = 0, r = 0; j < 4; ++j) {
+                if (j != k) rest[r++] = squares[j];
+            }
+            int score = -solve_last_3(opp_board & ~flips, own_board | flips | (1ULL << x), -beta, -alpha,
+                                      rest[0], rest[1], rest[2], false, ctx);
+            if (score > best_score) {
+                best_score = score;
+                alpha = std::max(alpha, score);
+                if (alpha >= beta) {
+                    return best_score; // Pruning
+                }
+            }
+        }
+
+        if (best_score == -ENDGAME_SCORE_BOUND) { // No legal move
+            if (passed) {
+                return final_score(own_board, opp_board);
+            }
+            return -solve_last_4(opp_board, own_board, -beta, -alpha, squares[0], squares[1], squares[2], squares[3], true, ctx);
+        }
+        return best_score;
+    }
+
+    /**
+     * @brief Dispatches a node with at most four empty cells to its hand-written solver.
+     */
+    int solve_last_few(uint64 own_board, uint64 opp_board, int alpha, int beta, bool passed, EndgameContext& ctx) {
+        uint64 empty_board = ~(own_board | opp_board);
+        int squares[4];
+        int count = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (empty_board & (1ULL << i)) {
+                squares[count++] = i;
+            }
+        }
+
+        switch (count) {
+            case 0:
+                ctx.nodes++;
+                return final_score(own_board, opp_board);
+            case 1:
+                return solve_last_1(own_board, opp_board, squares[0], ctx);
+            case 2:
+                return solve_last_2(own_board, opp_board, alpha, beta, squares[0], squares[1], passed, ctx);
+            case 3:
+                return solve_last_3(own_board, opp_board, alpha, beta, squares[0], squares[1], squares[2], passed, ctx);
+            default:
+                return solve_last_4(own_board, opp_board, alpha, beta, squares[0], squares[1], squares[2], squares[3], passed, ctx);
+        }
+    }
+
+    /**
+     * @brief Lists the legal moves of an endgame node in search order.
+     * * The table move goes first, then moves whose child has a stored score,
+     * then fastest-first far enough from the end and region parity closer to it.
+     * @param own_board The moving player's bitboard.
+     * @param opp_board The opponent's bitboard.
+     * @param legal_moves The legal moves of the player to move.
+     * @param empties The number of empty cells.
+     * @param tt_move The best move stored in the table, or -1.
+     * @param child_scores Stored child scores per cell, for the child's player to move (NO_SCORE if none), or nullptr.
+     * @param moves Output array with room for 64 moves.
+     * @return The number of moves written to `moves`.
+     */
+    int order_endgame_moves(uint64 own_board, uint64 opp_board, uint64 legal_moves, int empties, int tt_move,
+                            const int* child_scores, ScoredMove* moves) {
+        int count = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (legal_moves & (1ULL << i)) {
+                ScoredMove& move = moves[count++];
+                move.index = i;
+                if (i == tt_move) {
+                    move.score = std::numeric_limits<int>::max();
+                } else if (child_scores != nullptr && child_scores[i] != NO_SCORE) {
+                    move.score = STORED_SCORE_BONUS - child_scores[i];
+                } else if (empties >= ENDGAME_ORDERING_MIN_EMPTIES) {
+                    move.score = -opponent_mobility_after(own_board, opp_board, i);
+                } else {
+                    move.score = in_odd_region(i, ~(own_board | opp_board)) ? 1 : 0;
+                }
+            }
+        }
+        sort_moves(moves, count);
+        return count;
+    }
+
+    int solve_exact(uint64 own_board, uint64 opp_board, int alpha, int beta, bool passed, EndgameContext& ctx);
+
+    /**
+     * @brief Takes the moves of a split point one at a time until none are left or one cuts off.
+     * * @param sp The split point.
+     * @param ctx The context of the calling thread (owner or helper).
+     */
+    void search_split_moves(SplitPoint& sp, EndgameContext& ctx) {
+        const SplitPoint* saved_split = ctx.split;
+        ctx.split = &sp;
+        while (true) {
+            int k, alpha;
+            {
+                std::lock_guard<std::mutex> guard(sp.lock);
+                if (sp.cutoff.load(std::memory_order_relaxed) || sp.next_move >= sp.move_count) {
+                    break;
+                }
+                k = sp.next_move++;
+                alpha = sp.alpha;
+            }
+
+            int i = sp.moves[k].index;
+            uint64 flips = Core::get_flips(sp.own_board, sp.opp_board, i);
+            int score = -solve_exact(sp.opp_board & ~flips, sp.own_board | flips | (1ULL << i), -sp.beta, -alpha, false, ctx);
+            if (ctx.cancelled()) {
+                break;
+            }
+
+            std::lock_guard<std::mutex> guard(sp.lock);
+            if (score > sp.best_score) {
+                sp.best_score = score;
+                sp.best_move = i;
+                sp.alpha = std::max(sp.alpha, score);
+                if (sp.alpha >= sp.beta) {
+                    sp.cutoff.store(true, std::memory_order_relaxed); // Cancels the siblings
+                }
+            }
+        }
+        ctx.split = saved_split;
+    }
+
+    /**
+     * @brief True if `sp` lies below `ancestor` in the tree.
+     */
+    bool is_below(const SplitPoint* sp, const SplitPoint* ancestor) {
+        for (const SplitPoint* p = sp->parent; p != nullptr; p = p->parent) {
+            if (p == ancestor) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Joins a split point published by another thread and searches its moves.
+     * * @param ctx The context of the calling thread.
+     * @param ancestor If not nullptr, only split points below it are considered
+     * (a waiting owner helps its own helpers, so it is free again when they finish).
+     * @return True if some work was found.
+     */
+    bool steal_work(EndgameContext& ctx, const SplitPoint* ancestor) {
+        EndgamePool& pool = *ctx.pool;
+        int thread_count = (int)pool.workers.size();
+        SplitPoint* target = nullptr;
+
+        for (int n = 1; n < thread_count && target == nullptr; ++n) {
+            EndgamePool::Worker& victim = pool.workers[(ctx.thread_id + n) % thread_count];
+            std::lock_guard<std::mutex> deque_guard(victim.lock);
+            for (SplitPoint* sp : victim.split_points) {
+                if (ancestor != nullptr && !is_below(sp, ancestor)) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> guard(sp->lock);
+                if (!sp->cutoff.load(std::memory_order_relaxed) && sp->next_move < sp->move_count) {
+                    sp->helpers++; // Keeps the split point alive until we leave
+                    target = sp;
+                    break;
+                }
+            }
+        }
+        if (target == nullptr) {
+            return false;
+        }
+
+        pool.idle_threads.fetch_sub(1, std::memory_order_relaxed);
+        search_split_moves(*target, ctx);
+        pool.idle_threads.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> guard(target->lock);
+        target->helpers--;
+        return true;
+    }
+
+    /**
+     * @brief Main loop of a helper thread: steals work until the solve is over.
+     * * When there is nothing to steal, the helper sleeps until the next split
+     * point is published instead of spinning.
+     */
+    void run_endgame_helper(EndgameContext& ctx) {
+        EndgamePool& pool = *ctx.pool;
+        pool.idle_threads.fetch_add(1, std::memory_order_relaxed);
+        while (!pool.stop.load(std::memory_order_relaxed)) {
+            long long seen;
+            {
+                std::lock_guard<std::mutex> guard(pool.work_lock);
+                seen = pool.published;
+            }
+            if (!steal_work(ctx, nullptr)) {
+                std::unique_lock<std::mutex> guard(pool.work_lock);
+                pool.work_ready.wait(guard, [&]() {
+                    return pool.stop.load(std::memory_order_relaxed) || pool.published != seen;
+                });
+            }
+        }
+    }
+
+    /**
+     * @brief Searches the moves of an endgame node in order (fail-soft).
+     * * In a parallel solve, the eldest move is searched first; if it does not
+     * cut off, the subtree is large enough and some thread is idle, the
+     * remaining moves become a split point that idle threads may steal from.
+     * Idle threads are taken up near the root, so splits stay shallow.
+     * @param own_board The moving player's bitboard.
+     * @param opp_board The opponent's bitboard.
+     * @param alpha The alpha value.
+     * @param beta The beta value.
+     * @param moves The moves in search order.
+     * @param move_count The number of moves.
+     * @param empties The number of empty cells.
+     * @param best_move Receives the best move.
+     * @param ctx The endgame context.
+     * @return The best score; meaningless if ctx.cancelled().
+     */
+    int search_endgame_moves(uint64 own_board, uint64 opp_board, int alpha, int beta, const ScoredMove* moves, int move_count,
+                             int empties, int& best_move, EndgameContext& ctx) {
+        int best_score = -ENDGAME_SCORE_BOUND;
+        for (int k = 0; k < move_count; ++k) {
+            if (k == 1 && ctx.pool != nullptr && empties >= ENDGAME_SPLIT_MIN_EMPTIES &&
+                ctx.pool->idle_threads.load(std::memory_order_relaxed) > 0) {
+                SplitPoint sp;
+                sp.own_board = own_board;
+                sp.opp_board = opp_board;
+                sp.beta = beta;
+                sp.moves = moves;
+                sp.move_count = move_count;
+                sp.parent = ctx.split;
+                sp.next_move = 1;
+                sp.alpha = alpha;
+                sp.best_score = best_score;
+                sp.best_move = best_move;
+
+                EndgamePool::Worker& self = ctx.pool->workers[ctx.thread_id];
+                {
+                    std::lock_guard<std::mutex> guard(self.lock);
+                    self.split_points.push_back(&sp);
+                }
+                ctx.pool->publish();
+                search_split_moves(sp, ctx);
+                {
+                    std::lock_guard<std::mutex> guard(self.lock);
+                    self.split_points.erase(std::find(self.split_points.begin(), self.split_points.end(), &sp));
+                }
+
+                // Helpful master: rather than wait for the helpers, work on their subtrees
+                ctx.pool->idle_threads.fetch_add(1, std::memory_order_relaxed);
+                while (true) {
+                    {
+                        std::lock_guard<std::mutex> guard(sp.lock);
+                        if (sp.helpers == 0) {
+                            break;
+                        }
+                    }
+                    if (!steal_work(ctx, &sp)) {
+                        std::this_thread::yield();
+                    }
+                }
+                ctx.pool->idle_threads.fetch_sub(1, std::memory_order_relaxed);
+
+                best_move = sp.best_move;
+                return sp.best_score;
+            }
+
+            int i = moves[k].index;
+            uint64 flips = Core::get_flips(own_board, opp_board, i);
+            int score = -solve_exact(opp_board & ~flips, own_board | flips | (1ULL << i), -beta, -alpha, false, ctx);
+            if (ctx.cancelled()) {
+                break;
+            }
+
+            if (score > best_score) {
+                best_score = score;
+                best_move = moves[k].index;
+                alpha = std::max(alpha, score);
+                if (alpha >= beta) {
+                    break; // Pruning
+                }
+            }
+        }
+        return best_score;
+    }
+
+    /**
+     * @brief Exact alpha-beta (negamax) search to the end of the game.
+     * * @param own_board The moving player's bitboard.
+     * @param opp_board The opponent's bitboard.
+     * @param alpha The alpha value.
+     * @param beta The beta value.
+     * @param passed True if the previous player passed.
+     * @param ctx The endgame context.
+     * @return The final disc difference for the player to move (fail-soft).
+     */
+    int solve_exact(uint64 own_board, uint64 opp_board, int alpha, int beta, bool passed, EndgameContext& ctx) {
+        int empties = 64 - Core::count_discs(own_board | opp_board);
+        if (empties <= 4) {
+            return solve_last_few(own_board, opp_board, alpha, beta, passed, ctx);
+        }
+        ctx.nodes++;
+        if (ctx.abort != nullptr && (ctx.nodes & 1023) == 0) {
+            ctx.abort->poll();
+        }
+
+        uint64 key = 0;
+        if (empties >= ENDGAME_TT_MIN_EMPTIES) {
+            key = hash_position(own_board, opp_board);
+            ctx.tt->prefetch(key);
+        }
+
+        // Stability cutoff: the opponent keeps its stable discs, which caps the final score.
+        // Only worth computing when the opponent has enough discs for the cap to reach alpha.
+        if (alpha >= 64 - 2 * Core::count_discs(opp_board)) {
+            int upper_bound = 64 - 2 * Core::count_discs(Core::get_stable_discs(opp_board, own_board));
+            if (upper_bound <= alpha) {
+                return upper_bound;
+            }
+        }
+
+        uint64 legal_moves = Core::get_moves(own_board, opp_board);
+        if (legal_moves == 0) {
+            if (passed) {
+                return final_score(own_board, opp_board); // Neither player can move
+            }
+            return -solve_exact(opp_board, own_board, -beta, -alpha, true, ctx);
+        }
+
+        int tt_move = -1;
+        if (key != 0) {
+            TTEntry entry;
+            if (ctx.tt->probe(key, entry)) {
+                if (entry.bound == Bound::Exact) {
+                    return entry.score;
+                } else if (entry.bound == Bound::Lower) {
+                    alpha = std::max(alpha, entry.score);
+                } else {
+                    beta = std::min(beta, entry.score);
+                }
+                if (alpha >= beta) {
+                    return entry.score;
+                }
+                tt_move = entry.best_move;
+            }
+        }
+        int window_alpha = alpha;
+
+        // Enhanced transposition cutoff: a stored child upper bound low enough for
+        // the opponent proves a score at or above beta without searching
+        int child_scores[64];
+        bool use_etc = empties >= ENDGAME_ETC_MIN_EMPTIES;
+        if (use_etc) {
+            for (int i = 0; i < 64; ++i) {
+                child_scores[i] = NO_SCORE;
+                if (!(legal_moves & (1ULL << i))) {
+                    continue;
+                }
+                uint64 flips = Core::get_flips(own_board, opp_board, i);
+                TTEntry entry;
+                if (ctx.tt->probe(hash_position(opp_board & ~flips, own_board | flips | (1ULL << i)), entry)) {
+                    child_scores[i] = entry.score;
+                    if (entry.bound != Bound::Lower && -entry.score >= beta) {
+                        return -entry.score;
+                    }
+                }
+            }
+        }
+
+        ScoredMove moves[64];
+        int move_count = order_endgame_moves(own_board, opp_board, legal_moves, empties, tt_move,
+                                             use_etc ? child_scores : nullptr, moves);
+
+        int best_move = -1;
+        int best_score = search_endgame_moves(own_board, opp_board, alpha, beta, moves, move_count, empties, best_move, ctx);
+        if (ctx.cancelled()) {
+            return 0; // Incomplete: nothing is stored
+        }
+
+        if (key != 0) {
+            Bound bound = (best_score <= window_alpha) ? Bound::Upper : (best_score >= beta) ? Bound::Lower : Bound::Exact;
+            ctx.tt->store(key, empties, best_score, bound, best_move);
+        }
+        return best_score;
+    }
+
+    /**
+     * @brief Predicted relative size of the subtree after a move: the opponent's reply count.
+     */
+    int predicted_solve_cost(uint64 own_board, uint64 opp_board, int index) {
+        uint64 flips = Core::get_flips(own_board, opp_board, index);
+        return Core::count_discs(Core::get_moves(opp_board & ~flips, own_board | flips | (1ULL << index)));
+    }
+
+    /**
+     * @brief Solves the root position within a window.
+     * * With more than one thread, the extra threads help through split points
+     * (Young Brothers Wait Concept with work stealing). After the eldest, the
+     * root moves are handed out hardest first, so no long solve starts last
+     * while the other threads run out of work. With MTD(f), the window is
+     * narrowed by null-window passes sharing one table.
+     * @param state The current game state.
+     * @param alpha The alpha value.
+     * @param beta The beta value; the search stops at the first move reaching it.
+     * @param threads The number of search threads.
+     * @param root_search How the root value is found.
+     * @param kept_tt A table kept by the caller between solves, or nullptr for a fresh one.
+     * @param budget When to give up.
+     * @return The best move, its final disc difference for the player to move (as the score,
+     * fail-soft within the window), the number of empty cells (as the depth) and the node count.
+     * A solve that ran out of its budget has a depth of 0 and only a guessed move.
+     */
+    SearchResult solve_root(const GameState& state, int alpha, int beta, int threads, RootSearch root_search,
+                            TranspositionTable* kept_tt, const SolveBudget& budget) {
+        auto start = std::chrono::steady_clock::now();
+        SearchResult result;
+        uint64 own_board = (state.current_player == Player::Black) ? state.black_discs : state.white_discs;
+        uint64 opp_board = (state.current_player == Player::Black) ? state.white_discs : state.black_discs;
+        uint64 legal_moves = Core::get_moves(own_board, opp_board);
+
+        if (legal_moves == 0) {
+            return result; // Pass
+        }
+
+        int empties = 64 - Core::count_discs(own_board | opp_board);
+        if (empties < ENDGAME_SPLIT_MIN_EMPTIES) {
+            threads = 1; // No node of the solve is large enough to split: helpers would only wait
+        }
+        std::unique_ptr<TranspositionTable> fresh_tt;
+        TranspositionTable* tt = kept_tt;
+        if (tt == nullptr) {
+            bool large_table = threads > 1 || empties >= ENDGAME_LARGE_TT_EMPTIES;
+            fresh_tt.reset(new TranspositionTable(large_table ? ENDGAME_LARGE_TT_BITS : ENDGAME_TT_BITS));
+            tt = fresh_tt.get();
+        }
+        EndgamePool pool(std::max(1, threads), tt);
+        SolveAbort abort;
+        if (budget.stop != nullptr || budget.time_ms > 0) {
+            abort.stop = budget.stop;
+            abort.has_deadline = budget.time_ms > 0;
+            abort.deadline = start + std::chrono::milliseconds(budget.time_ms);
+            for (EndgamePool::Worker& worker : pool.workers) {
+                worker.ctx.abort = &abort;
+            }
+        }
+        EndgameContext& ctx = pool.workers[0].ctx;
+        if (threads <= 1) {
+            ctx.pool = nullptr;
+        }
+        std::vector<std::thread> helpers;
+        for (int t = 1; t < threads; ++t) {
+            helpers.emplace_back(run_endgame_helper, std::ref(pool.workers[t].ctx));
+        }
+
+        ScoredMove moves[64];
+        int move_count = order_endgame_moves(own_board, opp_board, legal_moves, empties, -1, nullptr, moves);
+        if (threads > 1 && move_count > 2) {
+            for (int k = 1; k < move_count; ++k) {
+                moves[k].score = predicted_solve_cost(own_board, opp_board, moves[k].index);
+            }
+            sort_moves(moves + 1, move_count - 1);
+        }
+        if (root_search == RootSearch::MTDf) {
+            int lower = alpha;
+            int upper = beta;
+            int value = std::max(alpha + 1, std::min(beta - 1, 0)); // Endgame scores cluster around zero
+            while (lower < upper) {
+                int pass_beta = (value == lower) ? value + 1 : value;
+                int pass_move = -1;
+                value = search_endgame_moves(own_board, opp_board, pass_beta - 1, pass_beta, moves, move_count, empties, pass_move, ctx);
+                if (ctx.cancelled()) {
+                    break;
+                }
+                result.stats.mtdf_passes++;
+                if (value < pass_beta) {
+                    upper = value;
+                } else {
+                    lower = value;
+                    result.best_move = pass_move;
+                    ScoredMove* best = std::find_if(moves, moves + move_count, [&](const ScoredMove& move) {
+                        return move.index == pass_move;
+                    });
+                    std::rotate(moves, best, best + 1);
+                }
+            }
+            result.score = value;
+        } else {
+            result.score = search_endgame_moves(own_board, opp_board, alpha, beta, moves, move_count, empties, result.best_move, ctx);
+        }
+        result.depth = empties;
+        if (ctx.cancelled()) {
+            result.best_move = moves[0].index;
+            result.score = 0;
+            result.depth = 0;
+        }
+
+        pool.finish();
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+        for (const EndgamePool::Worker& worker : pool.workers) {
+            result.stats.nodes += worker.ctx.nodes;
+        }
+        result.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    /**
+     * @brief Finds the best move by solving the game exactly (replaces the heuristic search near the end).
+     * * @param state The current game state.
+     * @param threads The number of search threads.
+     * @param root_search How the root value is found.
+     * @param tt A table kept between solves (exact results stay valid), or nullptr for a fresh one.
+     * @param budget When to give up; by default the solve runs to the end.
+     * @return The best move, the final disc difference for the player to move (as the score),
+     * the number of empty cells (as the depth, 0 if the budget ran out) and the node count.
+     */
+    SearchResult solve_endgame(const GameState& state, int threads = 1, RootSearch root_search = RootSearch::Aspiration,
+                               TranspositionTable* tt = nullptr, const SolveBudget& budget = SolveBudget()) {
+        return solve_root(state, -ENDGAME_SCORE_BOUND, ENDGAME_SCORE_BOUND, threads, root_search, tt, budget);
+    }
+
+    /**
+     * @brief Solves only whether the player to move wins, draws or loses (WLD).
+     * * Runs the endgame search with the window (-1, 1), which proves the sign of the
+     * final disc difference with far fewer nodes than the exact value.
+     * @param state The current game state.
+     * @param threads The number of search threads.
+     * @param tt A table kept between solves, or nullptr for a fresh one.
+     * @param budget When to give up; by default the solve runs to the end.
+     * @return A best move and, as the score, 1 for a win, 0 for a draw or -1 for a loss
+     * (the depth is 0 if the budget ran out).
+     */
+    SearchResult solve_wld(const GameState& state, int threads = 1, TranspositionTable* tt = nullptr,
+                           const SolveBudget& budget = SolveBudget()) {
+        SearchResult result = solve_root(state, -1, 1, threads, RootSearch::Aspiration, tt, budget);
+        result.score = (result.score > 0) - (result.score < 0);
+        return result;
+    }
+
+    /**
+     * @brief Finds a move the way the AI plays: solves the endgame when few enough cells are empty, otherwise searches.
+     * * With a time budget, a solve gets half of it. A solve that runs out of
+     * time or is stopped, and a WLD solve that finds no win or draw, leave the
+     * move to the heuristic search with the time that is left.
+     * @param state The current game state.
+     * @param limits The heuristic search's limits; their threads, root algorithm, stop flag and time budget also bound the solves.
+     * @param endgame_empties Solves exactly from this many empty cells.
+     * @param wld_empties Solves win/loss/draw from this many empty cells.
+     * @param endgame_tt The endgame table kept between solves, or nullptr for a fresh one.
+     */
+    SearchResult find_move(const GameState& state, SearchLimits limits, int endgame_empties, int wld_empties,
+                           TranspositionTable* endgame_tt) {
+        int empties = 64 - Core::count_discs(state.black_discs | state.white_discs);
+        bool exact = empties <= endgame_empties;
+        if (!exact && empties > wld_empties) {
+            return search(state, limits);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        SolveBudget budget;
+        budget.stop = limits.stop;
+        budget.time_ms = (limits.time_ms > 0) ? std::max(1, limits.time_ms / 2) : 0;
+        SearchResult solved = exact ? solve_endgame(state, limits.threads, limits.root_search, endgame_tt, budget)
+                                    : solve_wld(state, limits.threads, endgame_tt, budget);
+        if (solved.depth > 0 && (exact || solved.score >= 0)) {
+            return solved;
+        }
+
+        if (limits.time_ms > 0) {
+            int elapsed_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            limits.time_ms = std::max(1, limits.time_ms - elapsed_ms);
+        }
+        return search(state, limits);
+    }
+
+    // ---------------------------------------------------------------------
+    // Asynchronous search jobs
+    // ---------------------------------------------------------------------
+
+    /**
+     * @brief A snapshot of a running search.
+     */
+    struct SearchProgress {
+        int depth = 0;       // Last completed iteration
+        int score = 0;       // Its score for the player to move
+        int best_move = -1;  // Its best move
+        std::vector<int> pv; // Its expected line of play
+        long long nodes = 0; // Nodes of the main search thread up to that iteration (endgame solves: set when finished)
+        bool finished = false;
+    };
+
+    /**
+     * @brief A search running on a thread of its own.
+     * * Start it, poll its progress, stop it at any time, and wait for the result:
+     * a stopped search still returns the best move of its last completed iteration.
+     */
+    class SearchJob {
+    public:
+        using Task = std::function<SearchResult(const SearchLimits&)>;
+
+        SearchJob() = default;
+        SearchJob(const SearchJob&) = delete;
+        SearchJob& operator=(const SearchJob&) = delete;
+
+        ~SearchJob() {
+            stop();
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+        /**
+         * @brief Starts a heuristic search of the position.
+         */
+        void start(const GameState& state, const SearchLimits& limits) {
+            start([state](const SearchLimits& job_limits) { return search(state, job_limits); }, limits);
+        }
+
+        /**
+         * @brief Starts any search. The task receives `limits` with the job's stop flag
+         * and progress callback filled in; tasks that ignore them run to completion.
+         */
+        void start(Task task, SearchLimits limits) {
+            if (thread_.joinable()) {
+                stop();
+                thread_.join();
+            }
+            stop_.store(false);
+            progress_ = SearchProgress();
+            limits.stop = &stop_;
+            limits.on_iteration = [this](const SearchResult& iteration) {
+                std::lock_guard<std::mutex> guard(lock_);
+                progress_.depth = iteration.depth;
+                progress_.score = iteration.score;
+                progress_.best_move = iteration.best_move;
+                progress_.pv = iteration.pv;
+                progress_.nodes = iteration.stats.nodes;
+            };
+            thread_ = std::thread([this, task, limits]() {
+                SearchResult result = task(limits);
+                std::lock_guard<std::mutex> guard(lock_);
+                result_ = result;
+                progress_.depth = result.depth;
+                progress_.score = result.score;
+                progress_.best_move = result.best_move;
+                progress_.pv = result.pv;
+                progress_.nodes = result.stats.nodes;
+                progress_.finished = true;
+            });
+        }
+
+        SearchProgress progress() const {
+            std::lock_guard<std::mutex> guard(lock_);
+            return progress_;
+        }
+
+        bool finished() const {
+            return progress().finished;
+        }
+
+        /**
+         * @brief Asks the search to return as soon as possible.
+         */
+        void stop() {
+            stop_.store(true);
+        }
+
+        /**
+         * @brief Waits for the search to return and gives its result.
+         */
+        SearchResult wait() {
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+            return result_;
+        }
+
+    private:
+        std::thread thread_;
+        std::atomic<bool> stop_{false};
+        mutable std::mutex lock_; // Guards progress_ and result_
+        SearchProgress progress_;
+        SearchResult result_;
+    };
+
+} // namespace Engine
+
+
+// =========================================================================
+// Part 3: UI & APP (GameController & Main Loop)
+// =========================================================================
+
+namespace UI {
+
+    /**
+     * @brief Displays the game board, score, and turn with a larger UI.
+     */
+    void print_board(const GameState& state, uint64 legal_moves = 0ULL) {
+        // Column header row
+        std::cout << "\n  ";
+        for (int i = 0; i < 8; ++i) {
+            std::cout << "  " << (char)('A' + i) << " ";
+        }
+        std::cout << "\n";
+
+        // Top border of the board
+        std::cout << "\033[90m  +"; // Grey color
+        for (int i = 0; i < 8; ++i) {
+            std::cout << "---+";
+        }
+        std::cout << "\033[0m\n"; // Reset color
+
+        for (int row = 0; row < 8; ++row) {
+            // Row with pieces
+            std::cout << "\033[90m" << row + 1 << " |\033[0m"; // Grey color for row number and left border
+            for (int col = 0; col < 8; ++col) {
+                int index = row * 8 + col;
+                uint64 mask = (1ULL << index);
+                std::string piece_str = " ";
+                bool is_legal = (legal_moves & mask);
+
+                if (state.black_discs & mask) {
+                    piece_str = "\033[94m\u25CF\033[0m"; // Bright Blue
+                } else if (state.white_discs & mask) {
+                    piece_str = "\033[93m\u25CF\033[0m"; // Yellow
+                } else if (is_legal) {
+                    piece_str = ".";
+                }
+
+                std::cout << " " << piece_str << " \033[90m|\033[0m"; // Grey color for vertical separators
+            }
+            std::cout << "\n";
+
+            // Row border
+            std::cout << "\033[90m  +"; // Grey color
+            for (int i = 0; i < 8; ++i) {
+                std::cout << "---+";
+            }
+            std::cout << "\033[0m\n"; // Reset color
+        }
+
+
+        int black_score = Core::count_discs(state.black_discs);
+        int white_score = Core::count_discs(state.white_discs);
+        
+        std::cout << "\nScore: \033[94m\u25CF Blue\033[0m: " << black_score 
+                  << " | \033[93m\u25CF Yellow\033[0m: " << white_score << "\n";
+        
+        std::string player_name = (state.current_player == Player::Black) ? "\033[94m\u25CF Blue (You)\033[0m" : "\033[93m\u25CB Yellow (AI)\033[0m";
+        std::cout << "Turn: " << player_name << "\n";
+        std::cout << "Last Move: " << state.last_move_coord << "\n";
+    }
+
+    /**
+     * @brief Struct to store the result of command parsing.
+     */
+    struct Command {
+        enum Type { INVALID, MOVE, UNDO, HINT, QUIT, PASS, SOLVE_WLD };
+        Type type = INVALID;
+        int move_index = -1; // Only used if type == MOVE
+        int hint_count = 1;  // Only used if type == HINT: the number of ranked moves
+        std::string error_message;
+    };
+
+    /**
+     * @brief A strict UI command parser.
+     */
+    Command parse_command(const std::string& input, uint64 legal_moves) {
+        Command cmd;
+        std::string upper_input = input;
+        std::transform(upper_input.begin(), upper_input.end(), upper_input.begin(), ::toupper);
 
         // Trim whitespace
         upper_input.erase(upper_input.find_last_not_of(" \n\r\t")+1);
@@ -615,6 +3246,18 @@ namespace UI {
             cmd.type = Command::UNDO;
         } else if (upper_input == "?") {
             cmd.type = Command::HINT;
+        } else if (upper_input[0] == '?') {
+            std::istringstream count_stream(upper_input.substr(1));
+            int count = 0;
+            if (count_stream >> count && count >= 1 && count <= 64 && (count_stream >> std::ws).eof()) {
+                cmd.type = Command::HINT;
+                cmd.hint_count = count;
+            } else {
+                cmd.type = Command::INVALID;
+                cmd.error_message = "Usage: ? K, with K from 1 to 64 moves to rank.";
+            }
+        } else if (upper_input == "W" || upper_input == "SOLVE-WLD") {
+            cmd.type = Command::SOLVE_WLD;
         } else if (upper_input == "P") {
             if (Core::count_discs(legal_moves) == 0) {
                  cmd.type = Command::PASS;
@@ -622,39 +3265,275 @@ namespace UI {
                  cmd.type = Command::INVALID;
                  cmd.error_message = "Cannot PASS: You still have legal moves!";
             }
-        } else {
-            int index = coord_to_index(upper_input);
-            if (index != -1) {
-                uint64 mask = (1ULL << index);
-                if (legal_moves & mask) {
-                    cmd.type = Command::MOVE;
-                    cmd.move_index = index;
-                } else {
-                    cmd.type = Command::INVALID;
-                    cmd.error_message = "Move " + upper_input + " is not legal. Try a cell marked with (.).";
-                }
-            } else {
-                cmd.type = Command::INVALID;
-                cmd.error_message = "Unknown command. Try A1-H8, U, P, ?, or Q.";
+        } else {
+            int index = coord_to_index(upper_input);
+            if (index != -1) {
+                uint64 mask = (1ULL << index);
+                if (legal_moves & mask) {
+                    cmd.type = Command::MOVE;
+                    cmd.move_index = index;
+                } else {
+                    cmd.type = Command::INVALID;
+                    cmd.error_message = "Move " + upper_input + " is not legal. Try a cell marked with (.).";
+                }
+            } else {
+                cmd.type = Command::INVALID;
+                cmd.error_message = "Unknown command. Try A1-H8, U, P, ?, W, or Q.";
+            }
+        }
+        return cmd;
+    }
+
+    /**
+     * @brief Formats a line of play as space-separated coordinates; -1 is a pass.
+     */
+    std::string format_line(const std::vector<int>& line) {
+        std::string text;
+        for (int move : line) {
+            text += (text.empty() ? "" : " ") + (move < 0 ? std::string("PASS") : index_to_coord(move));
+        }
+        return text;
+    }
+
+    /**
+     * @brief Rewrites the status line of a running search.
+     */
+    void print_progress(const Engine::SearchProgress& progress) {
+        std::ostringstream line;
+        if (progress.depth == 0) {
+            line << "   searching...";
+        } else {
+            line << "   depth " << progress.depth << "  score " << progress.score << "  nodes " << progress.nodes
+                 << "  pv " << format_line(progress.pv);
+        }
+        std::cout << "\r" << std::left << std::setw(79) << line.str() << std::right << std::flush;
+    }
+
+    /**
+     * @brief Prints what a finished search did with its time.
+     * * Nodes and speed always; with search statistics compiled in, also the
+     * leaf evaluations, table use, cutoffs, re-searches, late move reductions, and the nodes, time and
+     * effective branching factor (nodes over the previous iteration's) per depth.
+     */
+    void print_search_stats(const Engine::SearchStats& stats) {
+        auto percent = [](long long part, long long whole) {
+            return whole > 0 ? 100.0 * part / whole : 0.0;
+        };
+        std::cout << std::fixed << std::setprecision(2)
+                  << "   " << stats.nodes << " nodes in " << stats.seconds << " s ("
+                  << (long long)(stats.nodes / std::max(stats.seconds, 1e-3)) << " nodes/s)\n";
+        if (!Engine::SEARCH_STATISTICS || stats.iterations.empty()) {
+            std::cout << std::defaultfloat;
+            return;
+        }
+
+        std::cout << std::setprecision(1)
+                  << "   leaves " << stats.leaf_evaluations.get()
+                  << ", TT probes " << stats.tt_probes.get() << " (" << percent(stats.tt_hits.get(), stats.tt_probes.get()) << "% hits)"
+                  << ", stores " << stats.tt_stores.get()
+                  << ", cutoffs " << stats.cutoffs.get() << " (" << percent(stats.first_move_cutoffs.get(), stats.cutoffs.get()) << "% first move)"
+                  << ", re-searches " << stats.window_researches()
+                  << ", MTD(f) passes " << stats.mtdf_passes
+                  << ", reduced " << stats.lmr_reductions << " (" << percent(stats.lmr_researches, stats.lmr_reductions) << "% re-searched)\n"
+                  << "   per depth:";
+        for (size_t i = 0; i < stats.iterations.size(); ++i) {
+            const Engine::IterationStats& iteration = stats.iterations[i];
+            std::cout << " " << iteration.depth << ": " << iteration.nodes << " nodes, " << iteration.seconds * 1000 << " ms";
+            if (i > 0 && stats.iterations[i - 1].nodes > 0) {
+                std::cout << ", EBF " << (double)iteration.nodes / stats.iterations[i - 1].nodes;
+            }
+            std::cout << (i + 1 < stats.iterations.size() ? " |" : "\n");
+        }
+        std::cout << std::defaultfloat;
+    }
+
+    // Set by SIGINT and SIGTERM: the game and --solve end early, so the hash file is still saved
+    std::atomic<bool> interrupt_requested{false};
+#if defined(__linux__)
+    pthread_t main_thread;
+#endif
+
+    void on_interrupt(int signal_number) {
+        interrupt_requested.store(true, std::memory_order_relaxed);
+#if defined(__linux__)
+        if (!pthread_equal(pthread_self(), main_thread)) {
+            pthread_kill(main_thread, signal_number); // Wakes the main thread from a blocking read
+        }
+#else
+        (void)signal_number;
+#endif
+    }
+
+    /**
+     * @brief Makes Ctrl+C and SIGTERM end the program through its normal exit path.
+     * * The handler only raises a flag. On Linux it is installed without
+     * SA_RESTART and forwarded to the main thread, so a read of the next
+     * command waiting there returns at once.
+     */
+    void install_interrupt_handler() {
+#if defined(__linux__)
+        main_thread = pthread_self();
+        struct sigaction action = {};
+        action.sa_handler = on_interrupt;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = 0; // No SA_RESTART
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+#else
+        std::signal(SIGINT, on_interrupt);
+        std::signal(SIGTERM, on_interrupt);
+#endif
+    }
+
+    bool interrupted() {
+        return interrupt_requested.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Shows the progress of a search until it finishes, keeping the terminal responsive.
+     * * An interrupt stops the search, which then returns its last completed iteration.
+     */
+    Engine::SearchResult follow_search(Engine::SearchJob& job) {
+        while (!job.finished()) {
+            if (interrupted()) {
+                job.stop();
             }
+            print_progress(job.progress());
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
-        return cmd;
+        print_progress(job.progress());
+        std::cout << "\n";
+        return job.wait();
     }
 } // namespace UI
 
 
+/**
+ * @brief A named strength of the AI: its search budget, selectivity and solver thresholds.
+ * * Budgets are in nodes, for levels that must answer within milliseconds on
+ * any machine, or in time, for levels that use every core for a fixed time.
+ */
+struct StrengthLevel {
+    const char* name;
+    long long nodes;          // Nodes per move (0: none)
+    int time_ms;              // Milliseconds per move (0: none)
+    double probcut_threshold; // Multi-ProbCut sigmas; lower prunes more
+    int endgame_empties;      // Solves exactly from this many empty cells
+    int wld_empties;          // Solves win/loss/draw from this many empty cells
+    bool all_cores;           // Searches on every hardware thread
+
+    /**
+     * @brief The limits of the level's midgame search, without a kept table.
+     */
+    Engine::SearchLimits search_limits() const {
+        Engine::SearchLimits limits;
+        limits.depth = Engine::MAX_SEARCH_DEPTH;
+        limits.nodes = nodes;
+        limits.time_ms = time_ms;
+        limits.threads = all_cores ? hardware_threads() : 1;
+        limits.selective.threshold = probcut_threshold;
+        return limits;
+    }
+
+    static int hardware_threads() {
+        return std::max(1, (int)std::thread::hardware_concurrency());
+    }
+};
+
+const StrengthLevel STRENGTH_LEVELS[] = {
+    // name       nodes  time  probcut endgame wld  all cores
+    {"beginner",    300,    0,  1.0,     6,     8, false},
+    {"casual",     3000,    0,  1.2,    10,    12, false},
+    {"normal",    30000,    0,  1.5,    14,    16, false},
+    {"strong",        0,  500,  1.5,    16,    18, true},
+    {"expert",        0, 2000,  2.0,    18,    20, true},
+};
+const int STRENGTH_LEVEL_COUNT = sizeof(STRENGTH_LEVELS) / sizeof(STRENGTH_LEVELS[0]);
+const int DEFAULT_STRENGTH_LEVEL = 2; // normal
+
+/**
+ * @brief Finds a strength level by name, or returns nullptr.
+ */
+const StrengthLevel* find_strength_level(const std::string& name) {
+    for (const StrengthLevel& level : STRENGTH_LEVELS) {
+        if (name == level.name) {
+            return &level;
+        }
+    }
+    return nullptr;
+}
+
+const int DEFAULT_HASH_MB = 128; // Memory of the kept transposition tables
+
 /**
  * @brief The controller class that mediates between the UI, Core, and Engine.
  */
 class GameController {
 private:
     std::vector<GameState> history_;
-    const int AI_DEPTH = 5; // AI search depth (can be adjusted)
+    const int AI_DEPTH = 5; // AI search depth when neither budget is set
+    std::string level_name_;   // The strength level the settings below came from
+    int endgame_empties_ = 0;  // Solve exactly from this many empty cells
+    int wld_empties_ = 0;      // Solve win/loss/draw from this many empty cells
+    int threads_ = 1;          // Search threads (midgame and endgame)
+    bool ponder_ = true;       // Search on the human's time
+    Engine::RootSearch root_search_ = Engine::RootSearch::Aspiration;
+    Engine::SelectiveSearch selective_;
+    long long node_budget_ = 0; // Nodes per move instead of the fixed depth (0: off)
+    int move_time_ms_ = 0;      // Milliseconds per move instead of the fixed depth (0: off)
+
+    // Kept between searches, moves and undos (aged rather than cleared), so every
+    // search starts warm; pondering fills them for the AI's next search.
+    // The hash memory (--hash) is split evenly between the two tables.
+    int hash_mb_ = DEFAULT_HASH_MB;
+    Engine::TranspositionTable search_tt_{hash_bits(DEFAULT_HASH_MB)};
+    Engine::TranspositionTable endgame_tt_{hash_bits(DEFAULT_HASH_MB)}; // Exact results stay valid for the whole game
+    Engine::SearchHeuristics heuristics_;
+    std::thread ponder_thread_;
+    std::atomic<bool> ponder_stop_{false};
+    int predicted_reply_ = -1; // The human's move in the AI's last principal variation, pondered first
+
+    /**
+     * @brief The limits of the AI's heuristic search, on the kept table and heuristics.
+     */
+    Engine::SearchLimits search_limits() {
+        Engine::SearchLimits limits;
+        limits.depth = AI_DEPTH;
+        limits.threads = threads_;
+        limits.root_search = root_search_;
+        limits.selective = selective_;
+        if (node_budget_ > 0 || move_time_ms_ > 0) {
+            limits.depth = Engine::MAX_SEARCH_DEPTH;
+            limits.nodes = node_budget_;
+            limits.time_ms = move_time_ms_;
+        }
+        limits.tt = &search_tt_;
+        limits.heuristics = &heuristics_;
+        return limits;
+    }
+
+    /**
+     * @brief Ages the kept search state; called once by each entry point that starts a search.
+     */
+    void begin_search() {
+        search_tt_.new_generation();
+        endgame_tt_.new_generation();
+        heuristics_.age();
+    }
+
+    static int hash_bits(int megabytes) {
+        return Engine::TranspositionTable::bits_for_bytes((size_t)megabytes * 1024 * 1024 / 2);
+    }
 
 public:
     GameController() {
         // Initialize the starting state
         history_.push_back(GameState());
+        set_level(STRENGTH_LEVELS[DEFAULT_STRENGTH_LEVEL]);
+    }
+
+    ~GameController() {
+        stop_pondering();
     }
 
     const GameState& get_current_state() const {
@@ -685,6 +3564,7 @@ public:
      */
     bool handle_undo() {
         if (history_.size() > 1) {
+            predicted_reply_ = -1;
             history_.pop_back();
             // If the AI is playing (Black vs. White), undo twice to return to the player's turn.
             if (get_current_state().current_player == Player::White && history_.size() > 1) {
@@ -696,11 +3576,204 @@ public:
     }
 
     /**
-     * @brief Gets the best move from the AI.
-     * @return The 0-63 index of the move, or -1 for a pass.
+     * @brief Applies a strength level: budgets, selectivity, solver thresholds and threads.
+     * * The other setters override single settings afterwards.
+     */
+    void set_level(const StrengthLevel& level) {
+        level_name_ = level.name;
+        node_budget_ = level.nodes;
+        move_time_ms_ = level.time_ms;
+        selective_.threshold = level.probcut_threshold;
+        endgame_empties_ = level.endgame_empties;
+        wld_empties_ = level.wld_empties;
+        threads_ = level.all_cores ? StrengthLevel::hardware_threads() : 1;
+    }
+
+    const std::string& level_name() const {
+        return level_name_;
+    }
+
+    /**
+     * @brief Resizes the kept tables to a memory budget in MB, split evenly; their contents are lost.
+     * * Meant for between games, with no search running.
+     */
+    void set_hash_size(int megabytes) {
+        stop_pondering();
+        hash_mb_ = std::max(1, megabytes);
+        search_tt_.resize(hash_bits(hash_mb_));
+        endgame_tt_.resize(hash_bits(hash_mb_));
+    }
+
+    /**
+     * @brief Describes the memory of the kept tables, e.g. "128 MB on huge pages".
+     */
+    std::string hash_description() const {
+        size_t megabytes = (search_tt_.size_bytes() + endgame_tt_.size_bytes()) / (1024 * 1024);
+        bool huge_pages = search_tt_.huge_pages() && endgame_tt_.huge_pages();
+        return std::to_string(megabytes) + " MB" + (huge_pages ? " on huge pages" : "");
+    }
+
+    /**
+     * @brief Writes the kept tables to a file, so a later run can start warm.
+     */
+    bool save_hash(const std::string& path) {
+        stop_pondering();
+        return Engine::save_hash_file(path, search_tt_, endgame_tt_);
+    }
+
+    /**
+     * @brief Maps the kept tables back from a file written with the same hash size.
+     */
+    bool load_hash(const std::string& path) {
+        stop_pondering();
+        return Engine::load_hash_file(path, search_tt_, endgame_tt_);
+    }
+
+    /**
+     * @brief The kept endgame table, for solving positions outside a game.
+     */
+    Engine::TranspositionTable* endgame_table() {
+        return &endgame_tt_;
+    }
+
+    /**
+     * @brief Sets the number of empty cells from which the AI solves the game exactly.
+     */
+    void set_endgame_empties(int empties) {
+        endgame_empties_ = empties;
+    }
+
+    /**
+     * @brief Sets the number of empty cells from which win/loss/draw can be solved.
+     */
+    void set_wld_empties(int empties) {
+        wld_empties_ = empties;
+    }
+
+    /**
+     * @brief Sets the number of threads used by the search and the endgame solver.
+     */
+    void set_threads(int threads) {
+        threads_ = std::max(1, threads);
+    }
+
+    int threads() const {
+        return threads_;
+    }
+
+    /**
+     * @brief Selects the root algorithm of the search and the endgame solver.
+     */
+    void set_root_search(Engine::RootSearch root_search) {
+        root_search_ = root_search;
+    }
+
+    /**
+     * @brief Searches a fixed number of nodes per move instead of a fixed depth (0 turns it off).
+     * * With one thread and no pondering, the AI's moves are then reproducible.
+     */
+    void set_node_budget(long long nodes) {
+        node_budget_ = std::max(0LL, nodes);
+    }
+
+    /**
+     * @brief Searches for a fixed time per move instead of a fixed depth (0 turns it off).
+     */
+    void set_move_time(int milliseconds) {
+        move_time_ms_ = std::max(0, milliseconds);
+    }
+
+    /**
+     * @brief Enables or disables searching on the human's time.
+     */
+    void set_ponder(bool ponder) {
+        ponder_ = ponder;
+    }
+
+    /**
+     * @brief Remembers the line the AI expects after its move, to ponder its reply first.
+     * @param pv The principal variation of the AI's search, starting with the AI's move.
+     */
+    void set_expected_line(const std::vector<int>& pv) {
+        predicted_reply_ = (pv.size() > 1) ? pv[1] : -1;
+    }
+
+    /**
+     * @brief Starts searching in the background while the human thinks.
+     * * Only when the AI's next move will use the heuristic search; the
+     * endgame solvers have tables of their own.
      */
-    int get_ai_move() const {
-        return Engine::find_best_move(get_current_state(), AI_DEPTH);
+    void start_pondering() {
+        const GameState& state = get_current_state();
+        int empties = 64 - Core::count_discs(state.black_discs | state.white_discs);
+        if (!ponder_ || ponder_thread_.joinable() || empties - 1 <= std::max(endgame_empties_, wld_empties_)) {
+            return;
+        }
+        ponder_stop_.store(false);
+        begin_search();
+        ponder_thread_ = std::thread(Engine::ponder, state, switch_player(state.current_player), predicted_reply_,
+                                     std::ref(search_tt_), std::ref(heuristics_), selective_, std::cref(ponder_stop_));
+    }
+
+    /**
+     * @brief Stops the background search; must be called before the game state changes.
+     */
+    void stop_pondering() {
+        if (ponder_thread_.joinable()) {
+            ponder_stop_.store(true);
+            ponder_thread_.join();
+        }
+    }
+
+    /**
+     * @brief Starts a search ranking the best moves of the player to move, with their scores.
+     * * One multi-PV search, on all threads and the kept table, instead of one
+     * search per candidate. Uses the heuristic search even in the endgame.
+     * @param job Receives the running search; its ranked moves are empty for a pass.
+     * @param count The number of moves to rank.
+     */
+    void start_ranked_hint(Engine::SearchJob& job, int count) {
+        begin_search();
+        Engine::SearchLimits limits = search_limits();
+        limits.multi_pv = count;
+        job.start(get_current_state(), limits);
+    }
+
+    /**
+     * @brief Starts the AI's search for the player to move.
+     * * Switches from the heuristic search to the exact endgame solver once
+     * the number of empty cells drops to the endgame threshold. A few empties
+     * earlier, a win/loss/draw solve picks a safe winning (or drawing) move;
+     * lost positions still use the heuristic search. Solves stay within the
+     * move's time budget (see Engine::find_move).
+     * @param job Receives the running search; its best move is -1 for a pass.
+     */
+    void start_ai_move(Engine::SearchJob& job) {
+        GameState state = get_current_state();
+        begin_search();
+        Engine::SearchLimits limits = search_limits();
+        Engine::TranspositionTable* endgame_tt = &endgame_tt_;
+        int endgame_empties = endgame_empties_;
+        int wld_empties = wld_empties_;
+        job.start([state, endgame_empties, wld_empties, endgame_tt](const Engine::SearchLimits& job_limits) {
+            return Engine::find_move(state, job_limits, endgame_empties, wld_empties, endgame_tt);
+        }, limits);
+    }
+
+    /**
+     * @brief Solves whether the player to move wins, draws or loses with perfect play.
+     * @param result Receives the score (1 win, 0 draw, -1 loss) and a move achieving it.
+     * @return False if there are too many empty cells to solve in reasonable time.
+     */
+    bool solve_wld(Engine::SearchResult& result) {
+        const GameState& state = get_current_state();
+        int empties = 64 - Core::count_discs(state.black_discs | state.white_discs);
+        if (empties > wld_empties_) {
+            return false;
+        }
+        endgame_tt_.new_generation();
+        result = Engine::solve_wld(state, threads_, &endgame_tt_);
+        return true;
     }
 
     /**
@@ -732,14 +3805,389 @@ public:
     }
 };
 
+// =========================================================================
+// Part 4: TOOLS (Offline calibration, run from the command line)
+// =========================================================================
+
+namespace Tools {
+
+    /**
+     * @brief Running sums for a least-squares fit of y = a * x + b.
+     */
+    struct LinearFit {
+        double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+
+        void add(double x, double y) {
+            n += 1; sx += x; sy += y; sxx += x * x; sxy += x * y; syy += y * y;
+        }
+
+        Engine::ProbCutModel model() const {
+            Engine::ProbCutModel m = {1.0, 0.0, 0.0};
+            double var_x = n * sxx - sx * sx;
+            if (n < 3 || var_x <= 0) {
+                return m;
+            }
+            m.a = (n * sxy - sx * sy) / var_x;
+            m.b = (sy - m.a * sx) / n;
+            // Residual sum of squares, expanded from the running sums
+            double rss = syy - 2 * m.a * sxy - 2 * m.b * sy + m.a * m.a * sxx + 2 * m.a * m.b * sx + m.b * m.b * n;
+            m.sigma = std::sqrt(std::max(0.0, rss / (n - 2)));
+            return m;
+        }
+    };
+
+    /**
+     * @brief Fits the Multi-ProbCut models from self-play positions.
+     * * Plays `games` games of shallow self-play with random deviations, searches
+     * every position at all depths of the ProbCut pairs (without selective search)
+     * and prints the fitted PROBCUT_MODELS table, ready to paste into the engine.
+     * @param games The number of self-play games.
+     */
+    void calibrate_probcut(int games) {
+        const int MAX_DEPTH = 8;
+        std::mt19937 rng(20250101);
+        LinearFit fits[Engine::PROBCUT_PAIR_COUNT][Engine::PROBCUT_PHASES];
+
+        Engine::TranspositionTable tt(Engine::SEARCH_TT_BITS);
+        Engine::SearchContext ctx;
+        ctx.tt = &tt;
+        ctx.selective.probcut = false;
+        ctx.selective.lmr = false;
+
+        for (int game = 0; game < games; ++game) {
+            GameState state;
+            while (true) {
+                uint64 legal_moves = Core::generate_legal_moves(state);
+                GameState next_player_state = state;
+                next_player_state.current_player = switch_player(state.current_player);
+                if (Core::is_terminal(state, legal_moves, Core::generate_legal_moves(next_player_state))) {
+                    break;
+                }
+                if (legal_moves == 0) {
+                    state = Core::apply_pass(state);
+                    continue;
+                }
+
+                // Sample the position from a random point of view, so both
+                // maximizing and minimizing nodes are represented
+                Player ai_player = (rng() % 2) ? Player::Black : Player::White;
+                bool maximizing_player = (ai_player == state.current_player);
+                int values[MAX_DEPTH + 1];
+                for (int depth = 1; depth <= MAX_DEPTH; ++depth) {
+                    tt.clear(); // Stored deeper results would leak into the shallow values
+                    values[depth] = Engine::minimax_ab(state, depth, std::numeric_limits<int>::min(),
+                                                       std::numeric_limits<int>::max(), maximizing_player, ai_player, ctx);
+                }
+                int phase = Engine::probcut_phase(state);
+                for (int p = 0; p < Engine::PROBCUT_PAIR_COUNT; ++p) {
+                    const Engine::ProbCutPair& pair = Engine::PROBCUT_PAIRS[p];
+                    fits[p][phase].add(values[pair.shallow_depth], values[pair.deep_depth]);
+                }
+
+                // Mostly sensible moves, with enough randomness to vary the games
+                int move_index;
+                if (rng() % 4 == 0) {
+                    std::vector<int> candidates;
+                    for (int i = 0; i < 64; ++i) {
+                        if (legal_moves & (1ULL << i)) candidates.push_back(i);
+                    }
+                    move_index = candidates[rng() % candidates.size()];
+                } else {
+                    move_index = Engine::find_best_move(state, 2);
+                }
+                state = Core::apply_move(state, move_index);
+            }
+            std::cerr << "Game " << game + 1 << "/" << games << " done.\n";
+        }
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "    const ProbCutModel PROBCUT_MODELS[PROBCUT_PAIR_COUNT][PROBCUT_PHASES] = {\n";
+        for (int p = 0; p < Engine::PROBCUT_PAIR_COUNT; ++p) {
+            std::cout << "        {";
+            for (int phase = 0; phase < Engine::PROBCUT_PHASES; ++phase) {
+                Engine::ProbCutModel m = fits[p][phase].model();
+                std::cout << (phase ? ", " : "") << "{" << m.a << ", " << m.b << ", " << m.sigma << "}";
+            }
+            std::cout << "}, // " << Engine::PROBCUT_PAIRS[p].deep_depth << " from " << Engine::PROBCUT_PAIRS[p].shallow_depth << "\n";
+        }
+        std::cout << "    };\n";
+    }
+
+
+    /**
+     * @brief Parses a position: 64 cells from A1 to H8 ('X' black, 'O' white, '-' empty),
+     * then the player to move ('X' or 'O'). Whitespace is ignored.
+     * @param text The position text.
+     * @param state Receives the position.
+     * @return False if the text is not a valid position.
+     */
+    bool parse_position(const std::string& text, GameState& state) {
+        std::string cells;
+        for (char c : text) {
+            if (!std::isspace((unsigned char)c)) {
+                cells += (char)std::toupper((unsigned char)c);
+            }
+        }
+        if (cells.size() != 65) {
+            return false;
+        }
+
+        state = GameState();
+        state.black_discs = 0;
+        state.white_discs = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (cells[i] == 'X') {
+                state.black_discs |= 1ULL << i;
+            } else if (cells[i] == 'O') {
+                state.white_discs |= 1ULL << i;
+            } else if (cells[i] != '-') {
+                return false;
+            }
+        }
+        if (cells[64] != 'X' && cells[64] != 'O') {
+            return false;
+        }
+        state.current_player = (cells[64] == 'X') ? Player::Black : Player::White;
+        return true;
+    }
+
+    /**
+     * @brief Measures what each strength level reaches on this machine.
+     * * Plays one reproducible self-play game at the default level and takes
+     * positions from it: midgame ones (beyond every level's solver thresholds)
+     * and endgame ones (within them). Each level moves in them as in a game,
+     * solver included, and the speed and depth of its midgame searches and its
+     * time per move in both phases are printed.
+     * @param positions The number of positions per phase searched by each level.
+     */
+    void calibrate_levels(int positions) {
+        int max_solver_empties = 0;
+        for (const StrengthLevel& level : STRENGTH_LEVELS) {
+            max_solver_empties = std::max(max_solver_empties, std::max(level.endgame_empties, level.wld_empties));
+        }
+
+        Engine::SearchLimits game_limits = STRENGTH_LEVELS[DEFAULT_STRENGTH_LEVEL].search_limits();
+        game_limits.threads = 1;
+        std::vector<GameState> midgame;
+        std::vector<GameState> endgame;
+        GameState state;
+        while (true) {
+            uint64 legal_moves = Core::generate_legal_moves(state);
+            if (legal_moves == 0) {
+                GameState passed = Core::apply_pass(state);
+                if (Core::generate_legal_moves(passed) == 0) {
+                    break; // Game over
+                }
+                state = passed;
+                continue;
+            }
+            int empties = 64 - Core::count_discs(state.black_discs | state.white_discs);
+            (empties > max_solver_empties ? midgame : endgame).push_back(state);
+            state = Core::apply_move(state, Engine::search(state, game_limits).best_move);
+        }
+        auto sample = [positions](const std::vector<GameState>& phase) {
+            std::vector<GameState> samples;
+            for (int i = 0; i < positions && !phase.empty(); ++i) {
+                samples.push_back(phase[i * phase.size() / positions]);
+            }
+            return samples;
+        };
+        std::vector<GameState> midgame_samples = sample(midgame);
+        std::vector<GameState> endgame_samples = sample(endgame);
+
+        std::cout << std::left << std::setw(10) << "level" << std::right << std::setw(8) << "threads" << std::setw(12) << "nodes/s"
+                  << std::setw(11) << "avg depth" << std::setw(11) << "min depth" << std::setw(10) << "avg ms" << std::setw(10) << "max ms"
+                  << std::setw(14) << "end avg ms" << std::setw(12) << "end max ms" << "\n";
+        for (const StrengthLevel& level : STRENGTH_LEVELS) {
+            Engine::SearchLimits limits = level.search_limits();
+            long long nodes = 0;
+            double seconds = 0;
+            double max_seconds = 0;
+            int depth_sum = 0;
+            int min_depth = Engine::MAX_SEARCH_DEPTH;
+            for (const GameState& position : midgame_samples) {
+                Engine::SearchResult result = Engine::find_move(position, limits, level.endgame_empties, level.wld_empties, nullptr);
+                nodes += result.stats.nodes;
+                seconds += result.stats.seconds;
+                max_seconds = std::max(max_seconds, result.stats.seconds);
+                depth_sum += result.depth;
+                min_depth = std::min(min_depth, result.depth);
+            }
+            double endgame_seconds = 0;
+            double endgame_max_seconds = 0;
+            for (const GameState& position : endgame_samples) {
+                auto start = std::chrono::steady_clock::now();
+                Engine::find_move(position, limits, level.endgame_empties, level.wld_empties, nullptr);
+                double move_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                endgame_seconds += move_seconds;
+                endgame_max_seconds = std::max(endgame_max_seconds, move_seconds);
+            }
+            int count = std::max<int>(1, midgame_samples.size());
+            int endgame_count = std::max<int>(1, endgame_samples.size());
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::left << std::setw(10) << level.name << std::right << std::setw(8) << limits.threads
+                      << std::setw(12) << (long long)(nodes / std::max(seconds, 1e-3))
+                      << std::setw(11) << (double)depth_sum / count << std::setw(11) << min_depth
+                      << std::setw(10) << seconds * 1000 / count << std::setw(10) << max_seconds * 1000
+                      << std::setw(14) << endgame_seconds * 1000 / endgame_count << std::setw(12) << endgame_max_seconds * 1000 << "\n";
+        }
+        std::cout << std::defaultfloat;
+    }
+
+    /**
+     * @brief Solves a position exactly and prints the result (for test positions).
+     * * @param position The position, in the parse_position format.
+     * @param threads The number of search threads.
+     * @param root_search The root algorithm of the solver.
+     * @param tt A kept endgame table to solve with, or null for a fresh one.
+     * @param stop If set, abandons the solve; the table keeps the subtrees already solved.
+     * @return False if the position is invalid.
+     */
+    bool solve_position(const std::string& position, int threads, Engine::RootSearch root_search,
+                        Engine::TranspositionTable* tt = nullptr, const std::atomic<bool>* stop = nullptr) {
+        GameState state;
+        if (!parse_position(position, state)) {
+            return false;
+        }
+        if (Core::count_discs(Core::generate_legal_moves(state)) == 0) {
+            state = Core::apply_pass(state);
+            std::cout << "The player to move passes.\n";
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        Engine::SolveBudget budget;
+        budget.stop = stop;
+        Engine::SearchResult result = Engine::solve_endgame(state, threads, root_search, tt, budget);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (result.depth == 0 && stop != nullptr && stop->load()) {
+            std::cout << "Interrupted after " << result.stats.nodes << " nodes.\n";
+            return true;
+        }
+
+        std::cout << "Empties: " << result.depth << "\n"
+                  << "Best move: " << index_to_coord(result.best_move) << "\n"
+                  << "Score: " << std::showpos << result.score << std::noshowpos << "\n"
+                  << "Nodes: " << result.stats.nodes << "\n"
+                  << "Time: " << std::fixed << std::setprecision(2) << seconds << " s ("
+                  << (long long)(result.stats.nodes / std::max(seconds, 1e-3)) << " nodes/s, "
+                  << threads << (threads == 1 ? " thread" : " threads") << ")\n";
+        return true;
+    }
+
+} // namespace Tools
+
 #ifdef _WIN32
+#define NOMINMAX // Keeps windows.h from defining min and max macros, which break std::min and std::max
 #include <windows.h> // For SetConsoleOutputCP
 #endif
 
 /**
  * @brief The main application function.
+ * * Options:
+ *   --calibrate-probcut [games]  Fits the Multi-ProbCut models and exits.
+ *   --calibrate-levels [n]       Measures each strength level on n positions and exits.
+ *   --level <name>               Selects a strength level (see STRENGTH_LEVELS); later options override it.
+ *   --hash <MB>                  Memory of the transposition tables (default DEFAULT_HASH_MB).
+ *   --hash-file <path>           Loads the tables from path at startup and saves them there at exit (also on SIGINT/SIGTERM).
+ *   --endgame-empties <n>        Solves the game exactly from n empty cells.
+ *   --wld-empties <n>            Solves win/loss/draw from n empty cells.
+ *   --threads <n>                Searches with n threads.
+ *   --no-ponder                  Does not search while the human thinks.
+ *   --root <aspiration|mtdf>     Selects the root algorithm.
+ *   --nodes <n>                  Searches n nodes per move (reproducible; turns pondering off).
+ *   --move-time <ms>             Searches for ms milliseconds per move.
+ *   --solve <position>           Solves a position exactly and exits (see Tools::parse_position).
  */
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--calibrate-probcut") {
+        Tools::calibrate_probcut(argc > 2 ? std::atoi(argv[2]) : 20);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--calibrate-levels") {
+        Tools::calibrate_levels(argc > 2 ? std::atoi(argv[2]) : 10);
+        return 0;
+    }
+
+    GameController controller;
+    Engine::RootSearch root_search = Engine::RootSearch::Aspiration;
+    std::string solve_position;
+    std::string hash_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--level" && i + 1 < argc) {
+            const StrengthLevel* level = find_strength_level(argv[++i]);
+            if (level == nullptr) {
+                std::cerr << "Unknown level: " << argv[i] << " (expected";
+                for (const StrengthLevel& known : STRENGTH_LEVELS) {
+                    std::cerr << " " << known.name;
+                }
+                std::cerr << ")\n";
+                return 1;
+            }
+            controller.set_level(*level);
+        } else if (option == "--hash" && i + 1 < argc) {
+            controller.set_hash_size(std::atoi(argv[++i]));
+        } else if (option == "--hash-file" && i + 1 < argc) {
+            hash_file = argv[++i];
+        } else if (option == "--endgame-empties" && i + 1 < argc) {
+            controller.set_endgame_empties(std::atoi(argv[++i]));
+        } else if (option == "--wld-empties" && i + 1 < argc) {
+            controller.set_wld_empties(std::atoi(argv[++i]));
+        } else if (option == "--threads" && i + 1 < argc) {
+            controller.set_threads(std::atoi(argv[++i]));
+        } else if (option == "--root" && i + 1 < argc) {
+            std::string root = argv[++i];
+            if (root == "mtdf") {
+                root_search = Engine::RootSearch::MTDf;
+            } else if (root == "aspiration") {
+                root_search = Engine::RootSearch::Aspiration;
+            } else {
+                std::cerr << "Unknown root algorithm: " << root << " (expected aspiration or mtdf)\n";
+                return 1;
+            }
+            controller.set_root_search(root_search);
+        } else if (option == "--nodes" && i + 1 < argc) {
+            controller.set_node_budget(std::atoll(argv[++i]));
+            controller.set_move_time(0);
+            controller.set_ponder(false); // Pondering would make the moves depend on the human's thinking time
+        } else if (option == "--move-time" && i + 1 < argc) {
+            controller.set_move_time(std::atoi(argv[++i]));
+            controller.set_node_budget(0);
+        } else if (option == "--no-ponder") {
+            controller.set_ponder(false);
+        } else if (option == "--solve" && i + 1 < argc) {
+            solve_position = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+
+    // Loaded after all options, since the file must match the final hash size
+    if (!hash_file.empty()) {
+        if (controller.load_hash(hash_file)) {
+            std::cout << "Hash loaded from " << hash_file << "\n";
+        } else {
+            std::cout << "Hash starts empty (" << hash_file << " is missing or was saved with another --hash or version)\n";
+        }
+    }
+    UI::install_interrupt_handler();
+    auto save_hash = [&]() {
+        if (!hash_file.empty() && !controller.save_hash(hash_file)) {
+            std::cerr << "Could not save the hash to " << hash_file << "\n";
+        }
+    };
+
+    if (!solve_position.empty()) {
+        Engine::TranspositionTable* tt = hash_file.empty() ? nullptr : controller.endgame_table();
+        if (!Tools::solve_position(solve_position, controller.threads(), root_search, tt, &UI::interrupt_requested)) {
+            std::cerr << "Invalid position: expected 64 cells (X, O or -) and the player to move.\n";
+            return 1;
+        }
+        save_hash();
+        return 0;
+    }
+
     // Set I/O for UTF-8 (for disc symbols)
 #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
@@ -757,14 +4205,13 @@ int main() {
     std::cout << "   \\  / __ / /_/ /\n";
     std::cout << "   /_/_/ |_\\____/\n";
     std::cout << "=YET-ANOTHER-OTHELLO=\n";
-    std::cout << "You (Blue) vs. AI (Yellow, Depth " << 5 << ")\n";
-    std::cout << "Commands: A1-H8 (e.g., D3), U (Undo), P (Pass), ? (Hint), Q (Quit)\n";
+    std::cout << "You (Blue) vs. AI (Yellow, " << controller.level_name() << ", hash " << controller.hash_description() << ")\n";
+    std::cout << "Commands: A1-H8 (e.g., D3), U (Undo), P (Pass), ? (Hint), ? K (Rank K moves), W (Solve win/loss/draw), Q (Quit)\n";
 
-    GameController controller;
     bool running = true;
     std::string input;
     
-    while (running) {
+    while (running && !UI::interrupted()) {
         const GameState& current_state = controller.get_current_state();
         uint64 human_legal_moves = Core::generate_legal_moves(current_state);
         
@@ -788,7 +4235,12 @@ int main() {
             }
 
             std::cout << "\n> ";
+            controller.start_pondering();
             std::getline(std::cin, input);
+            controller.stop_pondering();
+            if (UI::interrupted()) {
+                break;
+            }
 
             UI::Command cmd = UI::parse_command(input, human_legal_moves);
 
@@ -805,14 +4257,44 @@ int main() {
                     break;
                 case UI::Command::HINT: {
                     std::cout << ">> Finding AI hint...\n";
-                    int hint_index = controller.get_ai_move();
+                    Engine::SearchJob job;
+                    if (cmd.hint_count > 1) {
+                        controller.start_ranked_hint(job, cmd.hint_count);
+                        Engine::SearchResult hint = UI::follow_search(job);
+                        std::cout << ">> Hint: the best moves at depth " << hint.depth << "\n";
+                        for (size_t rank = 0; rank < hint.ranked.size(); ++rank) {
+                            const Engine::RankedMove& line = hint.ranked[rank];
+                            std::cout << "   " << rank + 1 << ". " << index_to_coord(line.move) << "  score " << line.score
+                                      << "  (" << UI::format_line(line.pv) << ")\n";
+                        }
+                        break;
+                    }
+                    controller.start_ai_move(job);
+                    Engine::SearchResult hint = UI::follow_search(job);
+                    int hint_index = hint.best_move;
                     if (hint_index != -1) {
-                         std::cout << ">> Hint: " << index_to_coord(hint_index) << "\n";
+                         std::cout << ">> Hint: " << index_to_coord(hint_index);
+                         if (hint.pv.size() > 1) {
+                             std::cout << " (expected line: " << UI::format_line(hint.pv) << ")";
+                         }
+                         std::cout << "\n";
                     } else {
                          std::cout << ">> Hint: PASS.\n";
                     }
                     break;
                 }
+                case UI::Command::SOLVE_WLD: {
+                    std::cout << ">> Solving win/loss/draw...\n";
+                    Engine::SearchResult wld;
+                    if (!controller.solve_wld(wld)) {
+                        std::cout << ">> Error: Too many empty cells to solve yet.\n";
+                    } else {
+                        const char* outcome = (wld.score > 0) ? "WINS" : (wld.score < 0) ? "LOSES" : "DRAWS";
+                        std::cout << ">> WLD: Blue " << outcome << " with perfect play (e.g., "
+                                  << index_to_coord(wld.best_move) << ").\n";
+                    }
+                    break;
+                }
                 case UI::Command::PASS:
                     controller.handle_pass();
                     std::cout << ">> Blue chose to PASS.\n";
@@ -830,14 +4312,25 @@ int main() {
             UI::print_board(current_state);
             std::cout << "\nYellow's Turn (AI). Thinking...\n";
 
-            int ai_move = controller.get_ai_move();
+            Engine::SearchJob job;
+            controller.start_ai_move(job);
+            Engine::SearchResult ai_result = UI::follow_search(job);
+            if (UI::interrupted()) {
+                break;
+            }
+            UI::print_search_stats(ai_result.stats);
+            int ai_move = ai_result.best_move;
             
             if (ai_move == -1) {
                 std::cout << ">> AI chose to PASS. (Yellow has no moves).\n";
                 controller.handle_pass();
             } else {
                 std::cout << ">> AI moves to: " << index_to_coord(ai_move) << "\n";
+                if (ai_result.pv.size() > 1) {
+                    std::cout << ">> Expected line: " << UI::format_line(ai_result.pv) << " (score " << ai_result.score << ")\n";
+                }
                 controller.handle_move(ai_move);
+                controller.set_expected_line(ai_result.pv);
             }
             // Add a visual pause
             #ifdef _WIN32
@@ -850,6 +4343,7 @@ int main() {
         }
     }
 
+    save_hash();
     std::cout << "\nThanks for playing!\n";
     return 0;
 }